@@ -1,6 +1,11 @@
 #pragma once
 
 // C++
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
 
 // Vendor
 #include <box2d/box2d.h>
@@ -0,0 +1,38 @@
+#include "pch.h"
+#include "source/core/app_service.h"
+#include "source/core/render_targets.h"
+
+static retron::app_service* app_service;
+
+retron::app_service::app_service()
+{
+    assert(!::app_service);
+    ::app_service = this;
+}
+
+retron::app_service::~app_service()
+{
+    assert(::app_service == this);
+    ::app_service = nullptr;
+}
+
+retron::app_service& retron::app_service::get()
+{
+    assert(::app_service);
+    return *::app_service;
+}
+
+ff::draw_ptr retron::app_service::begin_palette_draw()
+{
+    // Headless hosts have nothing to render to
+    retron::render_targets* targets = retron::app_service::get().render_targets();
+    if (!targets)
+    {
+        return nullptr;
+    }
+
+    ff::dx11_target_base& target = *targets->target(retron::render_target_types::palette_1);
+    ff::dx11_depth& depth = *targets->depth(retron::render_target_types::palette_1);
+
+    return retron::app_service::get().draw_device().begin_draw(target, &depth, retron::constants::RENDER_RECT, retron::constants::RENDER_RECT);
+}
@@ -26,12 +26,14 @@ namespace retron
         none = 0,
         invincible = 0x01,
         complete_level = 0x02,
+        rewind = 0x04,
     };
 
     class app_service
     {
     public:
-        virtual ~app_service() = default;
+        app_service();
+        virtual ~app_service();
 
         static app_service& get();
         static ff::draw_ptr begin_palette_draw();
@@ -47,12 +49,13 @@ namespace retron
         virtual void default_game_options(const retron::game_options& options) = 0;
 
         // Rendering
-        virtual ff::palette_base& palette() = 0;
+        virtual ff::palette_base& palette() = 0; // player 0's palette, see retron::helpers::create_player_palette
         virtual ff::palette_base& player_palette(size_t player) = 0;
         virtual ff::draw_device& draw_device() const = 0;
         virtual retron::render_targets* render_targets() const = 0;
         virtual void push_render_targets(retron::render_targets& targets) = 0;
         virtual void pop_render_targets(ff::dx11_target_base& final_target) = 0;
+        virtual ff::fixed_int render_interpolation() const = 0; // how far this render falls between the latest tick and the next one
 
         // Debug
         virtual ff::signal_sink<>& reload_resources_sink() = 0;
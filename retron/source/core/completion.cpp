@@ -0,0 +1,40 @@
+#include "pch.h"
+#include "source/core/completion.h"
+
+static const size_t SPIN_COUNT = 1024;
+
+retron::completion::completion()
+    : state(STATE_PENDING)
+{}
+
+void retron::completion::set()
+{
+    if (this->state.exchange(STATE_DONE, std::memory_order_acq_rel) == STATE_PARKED)
+    {
+#if defined(__cpp_lib_atomic_wait)
+        this->state.notify_one();
+#endif
+    }
+}
+
+void retron::completion::wait_and_reset()
+{
+    for (size_t i = 0; i < ::SPIN_COUNT && this->state.load(std::memory_order_acquire) != STATE_DONE; i++)
+    {
+    }
+
+    uint32_t expected = STATE_PENDING;
+    if (this->state.compare_exchange_strong(expected, STATE_PARKED, std::memory_order_acq_rel))
+    {
+        while (this->state.load(std::memory_order_acquire) == STATE_PARKED)
+        {
+#if defined(__cpp_lib_atomic_wait)
+            this->state.wait(STATE_PARKED, std::memory_order_acquire);
+#else
+            std::this_thread::yield();
+#endif
+        }
+    }
+
+    this->state.store(STATE_PENDING, std::memory_order_relaxed);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+namespace retron
+{
+    // Lets one thread wait for another to finish a task. The waiter spins briefly and only parks if the task isn't done by then,
+    // and the worker only wakes the waiter when it's actually parked.
+    class completion
+    {
+    public:
+        completion();
+        completion(const completion& other) = delete;
+
+        completion& operator=(const completion& other) = delete;
+
+        void set();
+        void wait_and_reset();
+
+    private:
+        enum : uint32_t
+        {
+            STATE_PENDING,
+            STATE_DONE,
+            STATE_PARKED,
+        };
+
+        std::atomic<uint32_t> state;
+    };
+}
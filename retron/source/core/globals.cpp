@@ -27,6 +27,10 @@ const size_t retron::input_events::ID_DEBUG_SPEED_FAST = ff::stable_hash_func("s
 const size_t retron::input_events::ID_DEBUG_RENDER_TOGGLE = ff::stable_hash_func("debug_render_toggle"sv);
 const size_t retron::input_events::ID_DEBUG_INVINCIBLE_TOGGLE = ff::stable_hash_func("invincible_toggle"sv);
 const size_t retron::input_events::ID_DEBUG_COMPLETE_LEVEL = ff::stable_hash_func("complete_level"sv);
+const size_t retron::input_events::ID_DEBUG_REWIND = ff::stable_hash_func("rewind"sv);
+const size_t retron::input_events::ID_DEBUG_PROFILE_TOGGLE = ff::stable_hash_func("profile_toggle"sv);
+const size_t retron::input_events::ID_DEBUG_FAST_FORWARD_TOGGLE = ff::stable_hash_func("fast_forward_toggle"sv);
+const size_t retron::input_events::ID_DEBUG_FAST_FORWARD_RENDER_EVERY = ff::stable_hash_func("fast_forward_render_every"sv);
 const size_t retron::input_events::ID_SHOW_CUSTOM_DEBUG = ff::stable_hash_func("show_custom_debug"sv);
 
 const size_t retron::commands::ID_DEBUG_HIDE_UI = ff::stable_hash_func("debug_hide_ui"sv);
@@ -35,6 +39,18 @@ const size_t retron::commands::ID_DEBUG_RESTART_GAME = ff::stable_hash_func("deb
 const size_t retron::commands::ID_DEBUG_RESTART_LEVEL = ff::stable_hash_func("debug_restart_level"sv);
 const size_t retron::commands::ID_DEBUG_REBUILD_RESOURCES = ff::stable_hash_func("debug_rebuild_resources"sv);
 
+const std::array<std::string_view, retron::particle_effect_ids::COUNT> retron::particle_effect_ids::NAMES =
+{
+    ""sv,
+    "player_bullet_explode"sv,
+    "player_bullet_smoke"sv,
+    "player_start"sv,
+    "grunt_start_0"sv,
+    "grunt_start_90"sv,
+    "hulk_start_0"sv,
+    "hulk_start_90"sv,
+};
+
 ff::fixed_int retron::helpers::dir_to_degrees(ff::point_fixed dir)
 {
     ff::fixed_int angle = dir ? ff::math::radians_to_degrees(std::atan2f(-dir.y, dir.x)) : 270.0f;
@@ -129,3 +145,17 @@ ff::point_fixed retron::helpers::get_press_vector(const ff::input_event_provider
 
     return ff::point_fixed(0, 0);
 }
+
+void retron::helpers::seed_random(uint32_t seed)
+{
+    std::srand(seed);
+}
+
+std::shared_ptr<ff::palette_cycle> retron::helpers::create_player_palette(const std::shared_ptr<ff::palette_data>& palette_data, size_t player)
+{
+    const float cycles_per_second = 0.25f;
+
+    std::ostringstream str;
+    str << "player_" << player;
+    return std::make_shared<ff::palette_cycle>(palette_data, str.str().c_str(), cycles_per_second);
+}
@@ -38,6 +38,10 @@ namespace retron::input_events
     extern const size_t ID_DEBUG_RENDER_TOGGLE;
     extern const size_t ID_DEBUG_INVINCIBLE_TOGGLE;
     extern const size_t ID_DEBUG_COMPLETE_LEVEL;
+    extern const size_t ID_DEBUG_REWIND;
+    extern const size_t ID_DEBUG_PROFILE_TOGGLE;
+    extern const size_t ID_DEBUG_FAST_FORWARD_TOGGLE;
+    extern const size_t ID_DEBUG_FAST_FORWARD_RENDER_EVERY;
     extern const size_t ID_SHOW_CUSTOM_DEBUG;
 }
 
@@ -50,6 +54,22 @@ namespace retron::commands
     extern const size_t ID_DEBUG_REBUILD_RESOURCES;
 }
 
+// Effects the code creates itself, each level resolves them to retron::particle_effects indexes when resources load
+namespace retron::particle_effect_ids
+{
+    const size_t ID_NONE = 0;
+    const size_t ID_PLAYER_BULLET_EXPLODE = 1;
+    const size_t ID_PLAYER_BULLET_SMOKE = 2;
+    const size_t ID_PLAYER_START = 3;
+    const size_t ID_GRUNT_START_0 = 4;
+    const size_t ID_GRUNT_START_90 = 5;
+    const size_t ID_HULK_START_0 = 6;
+    const size_t ID_HULK_START_90 = 7;
+    const size_t COUNT = 8;
+
+    extern const std::array<std::string_view, COUNT> NAMES; // effect names in level_particles, by id
+}
+
 namespace retron::constants
 {
     const size_t MAX_PLAYERS = 2;
@@ -81,4 +101,6 @@ namespace retron::helpers
     ff::point_fixed index_to_dir(size_t index); // degrees = index * 45
     ff::point_fixed canon_dir(const ff::point_fixed& value); // only -1, 0, or 1
     ff::point_fixed get_press_vector(const ff::input_event_provider& input_events, bool for_shoot);
+    void seed_random(uint32_t seed); // for replays, ff::math::random_* draws from the CRT generator
+    std::shared_ptr<ff::palette_cycle> create_player_palette(const std::shared_ptr<ff::palette_data>& palette_data, size_t player); // player 0 is also the main palette
 }
@@ -3,6 +3,7 @@
 namespace retron
 {
     class collision;
+    class snapshot;
     enum class entity_category;
     struct difficulty_spec;
     struct particle_effect_options;
@@ -26,6 +27,12 @@ namespace retron
         virtual void restart() = 0; // move from dead->ready
         virtual void stop() = 0; // move from dead->game_over
         virtual const std::vector<const retron::player*>& players() const = 0;
+        virtual void render_interpolation(ff::fixed_int value) = 0; // 0 renders the previous tick, 1 the latest
+
+        // Snapshots
+        virtual void save_snapshot(retron::snapshot& snapshot) const = 0;
+        virtual bool restore_snapshot(const retron::snapshot& snapshot) = 0; // false if the level had to start over instead
+        virtual bool restart_instant() = 0; // restore the state from when the level started playing
     };
 
     class level_logic_base
@@ -54,7 +61,8 @@ namespace retron
         virtual entt::registry& host_registry() = 0;
         virtual const retron::difficulty_spec& host_difficulty_spec() const = 0;
         virtual size_t host_frame_count() const = 0;
-        virtual void host_create_particles(std::string_view name, const ff::point_fixed& pos, const retron::particle_effect_options* options = nullptr) = 0;
+        virtual void host_create_particles(size_t effect_id, const ff::point_fixed& pos, const retron::particle_effect_options* options = nullptr) = 0; // effect_id from retron::particle_effect_ids
+        virtual void host_create_event_particles(const ff::dict& event_params, const ff::point_fixed& pos) = 0; // the params name any effect in level_particles
         virtual void host_create_bullet(entt::entity player_entity, ff::point_fixed shot_vector) = 0;
         virtual void host_handle_dead_player(entt::entity entity, const retron::player& player) = 0;
         virtual void host_add_points(const retron::player& player, size_t points) = 0;
@@ -76,5 +84,7 @@ namespace retron
         virtual const entt::registry& host_registry() const = 0;
         virtual const retron::difficulty_spec& host_difficulty_spec() const = 0;
         virtual size_t host_frame_count() const = 0;
+        virtual ff::fixed_int host_render_interpolation() const = 0;
+        virtual const ff::point_fixed* host_previous_position(entt::entity entity) const = 0; // nullptr when the entity didn't move last tick or interpolation is off
     };
 }
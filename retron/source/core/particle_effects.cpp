@@ -0,0 +1,56 @@
+#include "pch.h"
+#include "source/core/particle_effects.h"
+
+static std::mutex effects_mutex;
+static std::weak_ptr<const retron::particle_effects> weak_effects; // levels own the effects, so nothing is left to free after ff shuts down
+
+retron::particle_effects::particle_effects(ff::value_ptr value)
+    : source(value)
+{
+    ff::dict dict = value->get<ff::dict>();
+    for (std::string_view name : dict.child_names(true))
+    {
+        this->names_.emplace_back(name);
+        this->effects.emplace_back(dict.get(name));
+    }
+
+    assert(std::is_sorted(this->names_.cbegin(), this->names_.cend()));
+}
+
+std::shared_ptr<const retron::particle_effects> retron::particle_effects::get()
+{
+    ff::value_ptr value = ff::auto_resource_value("level_particles").value();
+    std::scoped_lock lock(::effects_mutex);
+
+    std::shared_ptr<const retron::particle_effects> effects = ::weak_effects.lock();
+
+    // Rebuilding resources creates a new value
+    if (!effects || effects->source != value)
+    {
+        effects = std::make_shared<retron::particle_effects>(value);
+        ::weak_effects = effects;
+    }
+
+    return effects;
+}
+
+size_t retron::particle_effects::index(std::string_view name) const
+{
+    auto i = std::lower_bound(this->names_.cbegin(), this->names_.cend(), name);
+    return (i != this->names_.cend() && *i == name) ? static_cast<size_t>(i - this->names_.cbegin()) : retron::particle_effects::NONE;
+}
+
+const retron::particles::effect_t* retron::particle_effects::effect(size_t index) const
+{
+    return (index < this->effects.size()) ? &this->effects[index] : nullptr;
+}
+
+const retron::particles::effect_t* retron::particle_effects::find(std::string_view name) const
+{
+    return this->effect(this->index(name));
+}
+
+const std::vector<std::string>& retron::particle_effects::names() const
+{
+    return this->names_;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "source/core/particles.h"
+
+namespace retron
+{
+    // All effects from the level_particles resource, shared by whoever is using them until resources are rebuilt.
+    // Effects have dense indexes in name order, look them up once and keep the index.
+    class particle_effects
+    {
+    public:
+        particle_effects(ff::value_ptr value);
+
+        static std::shared_ptr<const retron::particle_effects> get();
+
+        static const size_t NONE = static_cast<size_t>(-1);
+
+        size_t index(std::string_view name) const; // NONE when not found
+        const retron::particles::effect_t* effect(size_t index) const; // nullptr for NONE
+        const retron::particles::effect_t* find(std::string_view name) const;
+        const std::vector<std::string>& names() const;
+
+    private:
+        ff::value_ptr source;
+        std::vector<std::string> names_; // sorted
+        std::vector<retron::particles::effect_t> effects; // same order as names_
+    };
+}
@@ -1,184 +1,597 @@
 #include "pch.h"
 #include "source/core/particles.h"
+#include "source/core/profiler.h"
+
+static const size_t CHUNK_SIZE = 2048;
+static const size_t DEFAULT_BUDGET = 16384;
+static const int MAX_PRIORITY = 2;
+
+// Calls func with the same array from each buffer
+template<class FuncT, class... BufferTs>
+static void for_each_array(FuncT&& func, BufferTs&... buffers)
+{
+    func(buffers.angle...);
+    func(buffers.angle_vel...);
+    func(buffers.dist...);
+    func(buffers.dist_vel...);
+    func(buffers.spin...);
+    func(buffers.spin_vel...);
+    func(buffers.size...);
+    func(buffers.start_frame...);
+    func(buffers.move_frames...);
+    func(buffers.end_frame...);
+    func(buffers.group...);
+    func(buffers.type...);
+    func(buffers.color...);
+    func(buffers.anim...);
+    func(buffers.instance...);
+}
+
+size_t retron::particles::particle_buffer_t::count() const
+{
+    return this->end_frame.size();
+}
+
+void retron::particles::particle_buffer_t::reserve(size_t count)
+{
+    ::for_each_array([count](auto& values)
+        {
+            values.reserve(count);
+        }, *this);
+}
+
+void retron::particles::particle_buffer_t::resize(size_t count)
+{
+    ::for_each_array([count](auto& values)
+        {
+            values.resize(count);
+        }, *this);
+}
+
+void retron::particles::particle_buffer_t::push_back(const particle_t& p, uint32_t frame)
+{
+    // Same timing as stepping each frame: count down the delay, move while life > 1, then go away
+    const uint32_t start_frame = frame + p.delay;
+
+    this->angle.push_back(p.angle);
+    this->angle_vel.push_back(p.angle_vel);
+    this->dist.push_back(p.dist);
+    this->dist_vel.push_back(p.dist_vel);
+    this->spin.push_back(p.spin);
+    this->spin_vel.push_back(p.spin_vel);
+    this->size.push_back(p.size);
+    this->start_frame.push_back(start_frame);
+    this->move_frames.push_back(p.life ? p.life - 1u : 0u);
+    this->end_frame.push_back(start_frame + std::max<uint32_t>(p.life, 1));
+    this->group.push_back(p.group);
+    this->type.push_back(p.type);
+    this->color.push_back(p.is_color() ? p.color_ : 0);
+    this->anim.push_back(p.is_color() ? nullptr : p.anim);
+    this->instance.emplace_back();
+}
+
+void retron::particles::particle_buffer_t::push_back(const particle_buffer_t& source, size_t index)
+{
+    ::for_each_array([index](auto& values, const auto& source_values)
+        {
+            values.push_back(source_values[index]);
+        }, *this, source);
+}
+
+void retron::particles::particle_buffer_t::move(size_t from, size_t to)
+{
+    ::for_each_array([from, to](auto& values)
+        {
+            values[to] = values[from];
+        }, *this);
+}
+
+void retron::particles::particle_buffer_t::save(retron::snapshot& snapshot) const
+{
+    ::for_each_array([&snapshot](const auto& values)
+        {
+            snapshot.write(values);
+        }, *this);
+}
+
+void retron::particles::particle_buffer_t::restore(retron::snapshot::reader& reader)
+{
+    ::for_each_array([&reader](auto& values)
+        {
+            reader.read(values);
+        }, *this);
+}
 
 retron::particles::particles()
-    : async_event(ff::create_event())
+    : buckets(1)
+    , frame(0)
+    , chunks_remaining(0)
+    , budget_(::DEFAULT_BUDGET)
+    , live_count(0)
+    , stats_{}
 {
     this->particles_new.reserve(256);
-    this->particles_async.reserve(512);
+    this->buckets.front().reserve(512);
+    this->pending.reserve(256);
     this->groups.reserve(64);
 }
 
 ff::end_scope_action retron::particles::advance_async()
 {
-    ff::thread_pool::get()->add_task(std::bind(&particles::advance_now, this));
+    this->frame++;
+
+    size_t chunk_count = 0;
+    for (const particle_buffer_t& bucket : this->buckets)
+    {
+        chunk_count += (bucket.count() + ::CHUNK_SIZE - 1) / ::CHUNK_SIZE;
+    }
+
+    // There's always at least one task, since the last one to finish signals the event
+    this->chunks.resize(std::max<size_t>(chunk_count, 1));
+    this->chunks.front().bucket = 0;
+    this->chunks.front().start = 0;
+    this->chunks.front().end = 0;
+
+    for (size_t i = 0, chunk_index = 0; i < this->buckets.size(); i++)
+    {
+        for (size_t start = 0, count = this->buckets[i].count(); start < count; start += ::CHUNK_SIZE)
+        {
+            chunk_t& chunk = this->chunks[chunk_index++];
+            chunk.bucket = i;
+            chunk.start = start;
+            chunk.end = std::min(start + ::CHUNK_SIZE, count);
+        }
+    }
+
+    this->chunks_remaining = this->chunks.size();
+    this->update_group_matrices();
+
+    for (size_t i = 0; i < this->chunks.size(); i++)
+    {
+        ff::thread_pool::get()->add_task(std::bind(&particles::advance_chunk, this, i));
+    }
+
     return std::bind(&particles::advance_block, this);
 }
 
 void retron::particles::advance_block()
 {
-    // Don't use ff::wait_for_handle since it is alertable and might allow unexpected tasks to run
-    ::WaitForSingleObject(this->async_event, INFINITE);
-    ::ResetEvent(this->async_event);
+    retron::profiler::scope profile_scope("particles::advance_block");
+
+    this->async_done.wait_and_reset();
+    this->release_dead_groups();
+
+    // Picks up groups and positions that changed while the tasks were running
+    this->update_group_matrices();
 
-    if (this->particles_new.size())
+    for (const retron::particles::particle_t& p : this->particles_new)
     {
-        this->particles_async.insert(this->particles_async.end(), this->particles_new.begin(), this->particles_new.end());
-        this->particles_new.clear();
+        if (p.delay)
+        {
+            this->pending.push_back(p, this->frame);
+        }
+        else
+        {
+            retron::particles::particle_buffer_t& buffer = this->bucket(p.type);
+            buffer.push_back(p, this->frame);
+            this->update_instance(buffer, buffer.count() - 1);
+        }
     }
 
+    this->particles_new.clear();
+    this->update_live_count();
+
+    // Only groups that just finished are visited, and an effect is done when its last group goes
     ff::stack_vector<int, 32> effect_done;
 
-    for (auto& i : this->groups)
+    for (uint16_t group_id : this->finished_groups)
+    {
+        this->free_group(group_id, effect_done);
+    }
+
+    this->finished_groups.clear();
+
+    for (int i : effect_done)
+    {
+        this->effect_done_signal.notify(i);
+    }
+}
+
+void retron::particles::advance_chunk(size_t chunk_index)
+{
+    retron::profiler::scope profile_scope("particles::advance_chunk");
+
+    this->compact_chunk(this->chunks[chunk_index]);
+
+    if (this->chunks_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
     {
-        if (!i.refs)
+        this->merge_chunks();
+        this->async_done.set();
+    }
+}
+
+void retron::particles::compact_chunk(chunk_t& chunk)
+{
+    retron::particles::particle_buffer_t& buffer = this->buckets[chunk.bucket];
+    size_t keep = chunk.start;
+    chunk.dead_groups.clear();
+
+    for (size_t i = chunk.start; i < chunk.end; i++)
+    {
+        if (buffer.end_frame[i] <= this->frame)
         {
-            if (std::find(effect_done.cbegin(), effect_done.cend(), i.effect_id) == effect_done.cend())
+            chunk.dead_groups.push_back(buffer.group[i]);
+        }
+        else
+        {
+            if (keep != i)
             {
-                effect_done.push_back(i.effect_id);
+                buffer.move(i, keep);
             }
 
-            // Allow reuse of this group
-            i.refs = -1;
-            i.effect_id = 0;
-            i.animations.clear();
+            this->update_instance(buffer, keep++);
         }
     }
 
-    if (!effect_done.empty())
+    chunk.keep_count = keep - chunk.start;
+}
+
+void retron::particles::update_instance(particle_buffer_t& buffer, size_t index) const
+{
+    const float moved = static_cast<float>(std::min(this->frame - buffer.start_frame[index], buffer.move_frames[index]));
+    const float angle = buffer.angle[index] + buffer.angle_vel[index] * moved;
+    const float dist = buffer.dist[index] + buffer.dist_vel[index] * moved;
+
+    DirectX::XMFLOAT2 angle_cos_sin;
+    DirectX::XMScalarSinCosEst(&angle_cos_sin.y, &angle_cos_sin.x, angle);
+    DirectX::XMFLOAT2 pos(angle_cos_sin.x * dist, angle_cos_sin.y * dist);
+    DirectX::XMStoreFloat2(&pos,
+        DirectX::XMVector2Transform(
+            DirectX::XMLoadFloat2(&pos),
+            DirectX::XMLoadFloat4x4(&this->group_matrices[buffer.group[index]])));
+
+    retron::particles::instance_t& instance = buffer.instance[index];
+    instance.position = ff::point_float(pos.x, pos.y);
+    instance.size = buffer.size[index];
+    instance.rotation = buffer.spin[index] + buffer.spin_vel[index] * moved;
+    instance.color = buffer.color[index];
+    instance.anim = buffer.anim[index];
+    instance.anim_frame = instance.anim ? moved * ff::constants::seconds_per_advance_f * instance.anim->frames_per_second() : 0.0f;
+}
+
+void retron::particles::update_group_matrices()
+{
+    this->group_matrices.resize(this->groups.size());
+
+    for (size_t i = 0; i < this->groups.size(); i++)
+    {
+        this->group_matrices[i] = this->groups[i].matrix;
+    }
+}
+
+void retron::particles::merge_chunks()
+{
+    // Runs on whichever task finishes last, but always merges in chunk order
+    retron::profiler::scope profile_scope("particles::merge_chunks");
+    size_t dest = 0;
+
+    for (const chunk_t& chunk : this->chunks)
     {
-        for (auto& i : this->groups)
+        retron::particles::particle_buffer_t& buffer = this->buckets[chunk.bucket];
+        dest = chunk.start ? dest : 0;
+
+        if (dest != chunk.start)
         {
-            if (i.refs != -1)
+            for (size_t j = 0; j < chunk.keep_count; j++)
             {
-                auto h = std::find(effect_done.cbegin(), effect_done.cend(), i.effect_id);
-                if (h != effect_done.cend())
-                {
-                    effect_done.erase(h);
-                }
+                buffer.move(chunk.start + j, dest + j);
             }
         }
-    }
 
-    for (int i : effect_done)
-    {
-        this->effect_done_signal.notify(i);
+        dest += chunk.keep_count;
+
+        if (chunk.end == buffer.count())
+        {
+            buffer.resize(dest);
+        }
     }
+
+    this->promote_pending();
 }
 
-void retron::particles::advance_now()
+void retron::particles::promote_pending()
 {
-    for (size_t i = 0; i < this->particles_async.size(); )
+    // Delayed particles can't expire, so they only need to move to their bucket once they start
+    retron::particles::particle_buffer_t& pending = this->pending;
+    size_t keep = 0;
+
+    for (size_t i = 0, count = pending.count(); i < count; i++)
     {
-        retron::particles::particle_t& p = particles_async[i];
-        if (p.delay > 0)
+        if (pending.start_frame[i] <= this->frame)
         {
-            p.delay--;
-            i++;
-        }
-        else if (p.life > 1)
-        {
-            p.life--;
-            p.angle += p.angle_vel;
-            p.dist += p.dist_vel;
-            p.spin += p.spin_vel;
-            p.timer += ff::constants::seconds_per_advance_f;
-            i++;
+            retron::particles::particle_buffer_t& buffer = this->bucket(pending.type[i]);
+            buffer.push_back(pending, i);
+            this->update_instance(buffer, buffer.count() - 1);
         }
         else
         {
-            this->release_group(p.group);
-            p = std::move(this->particles_async.back());
-            this->particles_async.pop_back();
+            if (keep != i)
+            {
+                pending.move(i, keep);
+            }
+
+            keep++;
         }
     }
 
-    ::SetEvent(this->async_event);
+    pending.resize(keep);
 }
 
-uint16_t retron::particles::add_group(const ff::pixel_transform& transform, int effect_id, int count, const std::vector<std::shared_ptr<ff::animation_base>>& animations)
+retron::particles::particle_buffer_t& retron::particles::bucket(uint8_t type)
 {
+    if (type >= this->buckets.size())
+    {
+        this->buckets.resize(static_cast<size_t>(type) + 1);
+    }
+
+    return this->buckets[type];
+}
+
+uint16_t retron::particles::add_group(const ff::pixel_transform& transform, int effect_id, int count, const std::shared_ptr<const animations_t>& animations)
+{
+    static_assert(std::is_trivially_copyable_v<retron::particles::group_t>);
+
     retron::particles::group_t group;
     DirectX::XMStoreFloat4x4(&group.matrix, transform.matrix());
     group.transform = transform;
     group.refs = count;
     group.effect_id = effect_id;
-    group.animations = animations;
+    group.animations = this->animations_index(animations);
 
-    for (size_t i = 0; i < this->groups.size(); i++)
+    uint16_t group_id;
+    if (this->free_groups.empty())
+    {
+        group_id = static_cast<uint16_t>(this->groups.size());
+        this->groups.push_back(std::move(group));
+    }
+    else
     {
-        if (this->groups[i].refs == -1)
+        group_id = this->free_groups.back();
+        this->free_groups.pop_back();
+        this->groups[group_id] = std::move(group);
+    }
+
+    this->effect_groups[effect_id].push_back(group_id);
+
+    if (!count)
+    {
+        // No particles will release it
+        this->finished_groups.push_back(group_id);
+    }
+
+    return group_id;
+}
+
+uint16_t retron::particles::animations_index(const std::shared_ptr<const animations_t>& animations)
+{
+    // Only lists of live groups are kept, so this stays as short as the number of specs on screen
+    size_t free_index = this->animation_lists.size();
+
+    for (size_t i = 0; i < this->animation_lists.size(); i++)
+    {
+        animation_list_t& list = this->animation_lists[i];
+        if (list.animations == animations)
         {
-            this->groups[i] = std::move(group);
+            list.groups++;
             return static_cast<uint16_t>(i);
         }
+        else if (!list.animations && free_index == this->animation_lists.size())
+        {
+            free_index = i;
+        }
     }
 
-    this->groups.push_back(std::move(group));
-    return static_cast<uint16_t>(this->groups.size() - 1);
+    if (free_index == this->animation_lists.size())
+    {
+        this->animation_lists.emplace_back();
+    }
+
+    this->animation_lists[free_index] = animation_list_t{ animations, 1 };
+    return static_cast<uint16_t>(free_index);
+}
+
+void retron::particles::release_animations(uint16_t index)
+{
+    // The group's particles are all dead, so nothing points into the list anymore
+    animation_list_t& list = this->animation_lists[index];
+    if (!--list.groups)
+    {
+        list.animations.reset();
+    }
 }
 
 void retron::particles::release_group(uint16_t group_id)
 {
-    --this->groups[group_id].refs;
+    if (!--this->groups[group_id].refs)
+    {
+        this->finished_groups.push_back(group_id);
+    }
 }
 
-const DirectX::XMFLOAT4X4& retron::particles::matrix(uint16_t group_id) const
+void retron::particles::release_dead_groups()
 {
-    assert(this->groups[group_id].refs > 0);
-    return this->groups[group_id].matrix;
+    // The tasks only collect dead particles' groups, since the main thread may be adding groups while they run
+    for (chunk_t& chunk : this->chunks)
+    {
+        for (uint16_t group_id : chunk.dead_groups)
+        {
+            this->release_group(group_id);
+        }
+
+        chunk.dead_groups.clear();
+    }
 }
 
-void retron::particles::render(ff::draw_base& draw, uint8_t type)
+void retron::particles::free_group(uint16_t group_id, ff::stack_vector<int, 32>& effect_done)
 {
-    ff::transform transform = ff::transform::identity();
+    group_t& group = this->groups[group_id];
+    auto effect = this->effect_groups.find(group.effect_id);
+    assert(effect != this->effect_groups.end());
 
-    for (const retron::particles::particle_t& p : this->particles_async)
+    if (effect != this->effect_groups.end())
     {
-        if (!p.delay && type == p.type)
+        auto& group_ids = effect->second;
+        auto i = std::find(group_ids.begin(), group_ids.end(), group_id);
+        assert(i != group_ids.end());
+
+        if (i != group_ids.end())
         {
-            DirectX::XMFLOAT2 angle_cos_sin;
-            DirectX::XMScalarSinCosEst(&angle_cos_sin.y, &angle_cos_sin.x, p.angle);
-            DirectX::XMFLOAT2 pos(angle_cos_sin.x * p.dist, angle_cos_sin.y * p.dist);
-            DirectX::XMStoreFloat2(&pos,
-                DirectX::XMVector2Transform(
-                    DirectX::XMLoadFloat2(&pos),
-                    DirectX::XMLoadFloat4x4(&this->matrix(p.group))));
+            group_ids.erase(i);
+        }
 
-            if (p.is_color())
-            {
-                draw.draw_palette_filled_rectangle(ff::rect_float(pos.x - p.size, pos.y - p.size, pos.x + p.size, pos.y + p.size), p.color_);
-            }
-            else
+        if (group_ids.empty())
+        {
+            effect_done.push_back(group.effect_id);
+            this->effect_groups.erase(effect);
+        }
+    }
+
+    this->release_animations(group.animations);
+
+    // Allow reuse of this group
+    group.refs = -1;
+    group.effect_id = 0;
+    this->free_groups.push_back(group_id);
+}
+
+void retron::particles::rebuild_group_index()
+{
+    this->free_groups.clear();
+    this->finished_groups.clear();
+    this->effect_groups.clear();
+
+    for (size_t i = this->groups.size(); i > 0; i--)
+    {
+        const group_t& group = this->groups[i - 1];
+        if (group.refs == -1)
+        {
+            this->free_groups.push_back(static_cast<uint16_t>(i - 1));
+        }
+        else
+        {
+            this->effect_groups[group.effect_id].push_back(static_cast<uint16_t>(i - 1));
+            this->animation_lists[group.animations].groups++;
+
+            if (!group.refs)
             {
-                transform.position = ff::point_float(pos.x, pos.y);
-                transform.scale = ff::point_float(p.size, p.size);
-                transform.rotation = p.spin;
-                p.anim->draw_frame(draw, transform, p.timer * p.anim->frames_per_second());
+                this->finished_groups.push_back(static_cast<uint16_t>(i - 1));
             }
         }
     }
+
+    for (animation_list_t& list : this->animation_lists)
+    {
+        if (!list.groups)
+        {
+            list.animations.reset();
+        }
+    }
 }
 
-bool retron::particles::effect_active(int effect_id) const
+void retron::particles::update_live_count()
 {
-    for (auto& group : this->groups)
+    this->live_count = this->pending.count();
+
+    for (const particle_buffer_t& bucket : this->buckets)
     {
-        if (group.effect_id == effect_id && group.refs != -1)
+        this->live_count += bucket.count();
+    }
+
+    this->stats_.peak_count = std::max(this->stats_.peak_count, this->live_count);
+}
+
+int retron::particles::budget_count(int count, int priority)
+{
+    priority = std::clamp(priority, 0, ::MAX_PRIORITY);
+
+    const size_t limit = this->budget_ * (priority + 1) / (::MAX_PRIORITY + 1);
+    const size_t used = this->live_count + this->particles_new.size();
+    const size_t room = (limit > used) ? limit - used : 0;
+
+    if (static_cast<size_t>(count) > room)
+    {
+        const int new_count = static_cast<int>(room);
+        this->stats_.thinned_spawns++;
+        this->stats_.dropped_particles += count - new_count;
+        count = new_count;
+    }
+
+    return count;
+}
+
+void retron::particles::render(ff::draw_base& draw, uint8_t type)
+{
+    if (type >= this->buckets.size())
+    {
+        return;
+    }
+
+    ff::transform transform = ff::transform::identity();
+    std::vector<ff::point_float>& points = this->render_points;
+    std::vector<int>& colors = this->render_colors;
+
+    // Runs of colored particles go out as one draw, animations are drawn in between to keep the same overlap
+    auto flush_colors = [&draw, &points, &colors]()
+        {
+            if (colors.size())
+            {
+                draw.draw_palette_filled_triangles(points.data(), colors.data(), colors.size() / 3);
+                points.clear();
+                colors.clear();
+            }
+        };
+
+    for (const retron::particles::instance_t& instance : this->buckets[type].instance)
+    {
+        if (!instance.anim)
         {
-            return true;
+            const ff::point_float& pos = instance.position;
+            const float size = instance.size;
+            const ff::point_float top_left(pos.x - size, pos.y - size);
+            const ff::point_float top_right(pos.x + size, pos.y - size);
+            const ff::point_float bottom_left(pos.x - size, pos.y + size);
+            const ff::point_float bottom_right(pos.x + size, pos.y + size);
+
+            points.insert(points.end(), { top_left, top_right, bottom_right, bottom_right, bottom_left, top_left });
+            colors.insert(colors.end(), 6, instance.color);
+        }
+        else
+        {
+            flush_colors();
+
+            transform.position = instance.position;
+            transform.scale = ff::point_float(instance.size, instance.size);
+            transform.rotation = instance.rotation;
+            instance.anim->draw_frame(draw, transform, instance.anim_frame);
         }
     }
 
-    return false;
+    flush_colors();
+}
+
+bool retron::particles::effect_active(int effect_id) const
+{
+    return this->effect_groups.find(effect_id) != this->effect_groups.end();
 }
 
 void retron::particles::effect_position(int effect_id, ff::point_fixed pos)
 {
-    for (auto& group : this->groups)
+    auto effect = this->effect_groups.find(effect_id);
+    if (effect != this->effect_groups.end())
     {
-        if (group.effect_id == effect_id && group.refs != -1)
+        for (uint16_t group_id : effect->second)
         {
+            group_t& group = this->groups[group_id];
             group.transform.position = pos;
             DirectX::XMStoreFloat4x4(&group.matrix, group.transform.matrix());
         }
@@ -190,6 +603,87 @@ ff::signal_sink<int>& retron::particles::effect_done_sink()
     return this->effect_done_signal;
 }
 
+void retron::particles::budget(size_t max_count)
+{
+    this->budget_ = max_count;
+}
+
+size_t retron::particles::budget() const
+{
+    return this->budget_;
+}
+
+const retron::particles::stats_t& retron::particles::stats() const
+{
+    return this->stats_;
+}
+
+void retron::particles::save(retron::snapshot& snapshot) const
+{
+    snapshot.write(this->particles_new);
+    snapshot.write(this->buckets.size());
+
+    for (const particle_buffer_t& bucket : this->buckets)
+    {
+        bucket.save(snapshot);
+    }
+
+    this->pending.save(snapshot);
+    snapshot.write(this->frame);
+    snapshot.write(this->animation_lists.size());
+
+    for (const animation_list_t& list : this->animation_lists)
+    {
+        snapshot.write_object(std::const_pointer_cast<animations_t>(list.animations));
+    }
+
+    snapshot.write(this->groups.size());
+
+    for (const group_t& group : this->groups)
+    {
+        snapshot.write(group.transform);
+        snapshot.write(group.refs);
+        snapshot.write(group.effect_id);
+        snapshot.write(group.animations);
+    }
+}
+
+void retron::particles::restore(retron::snapshot::reader& reader)
+{
+    reader.read(this->particles_new);
+    this->buckets.resize(reader.read<size_t>());
+
+    for (particle_buffer_t& bucket : this->buckets)
+    {
+        bucket.restore(reader);
+    }
+
+    this->pending.restore(reader);
+    this->frame = reader.read<uint32_t>();
+    this->animation_lists.resize(reader.read<size_t>());
+
+    // Particles point directly at animations, which stay alive because the snapshot shares the lists
+    for (animation_list_t& list : this->animation_lists)
+    {
+        list.animations = reader.read_object<animations_t>();
+        list.groups = 0;
+    }
+
+    this->groups.resize(reader.read<size_t>());
+
+    for (group_t& group : this->groups)
+    {
+        group.transform = reader.read<ff::pixel_transform>();
+        group.refs = reader.read<int>();
+        group.effect_id = reader.read<int>();
+        group.animations = reader.read<uint16_t>();
+        DirectX::XMStoreFloat4x4(&group.matrix, group.transform.matrix());
+    }
+
+    this->rebuild_group_index();
+    this->update_live_count();
+}
+
 template<typename ValueT, typename T = typename ff::type::value_derived_traits<ValueT>::raw_type>
 static std::pair<T, T> read_pair(const ff::dict& dict, std::string_view name, T default1, T default2, bool* has_value)
 {
@@ -250,8 +744,11 @@ retron::particles::spec_t::spec_t(const ff::dict& dict)
     this->rotate = dict.get<ff::fixed_int>("rotate");
     this->scale = dict.get<ff::point_fixed>("scale", ff::point_fixed(1, 1));
     this->reverse = dict.get<bool>("reverse");
+    this->priority = dict.get<int>("priority");
     this->colors = dict.get<std::vector<int>>("colors");
 
+    auto animations = std::make_shared<animations_t>();
+
     for (ff::value_ptr value : dict.get<std::vector<ff::value_ptr>>("animations"))
     {
         ff::value_ptr valuet = value->try_convert<ff::resource>();
@@ -263,54 +760,151 @@ retron::particles::spec_t::spec_t(const ff::dict& dict)
 
             if (anim)
             {
-                this->animations.push_back(anim);
+                animations->push_back(anim);
             }
         }
     }
+
+    this->animations = animations;
+}
+
+retron::particles::random_t::random_t(uint32_t seed)
+{
+    for (uint32_t& lane_state : this->state)
+    {
+        seed = seed * 747796405u + 2891336453u;
+        lane_state = (seed ^ (seed >> 16)) | 1; // xorshift gets stuck on zero
+    }
 }
 
-size_t retron::particles::spec_t::add(particles& particles, ff::point_fixed pos, int effect_id, const retron::particle_effect_options& options) const
+void retron::particles::random_t::next(std::array<uint32_t, 4>& bits)
+{
+    // Four independent lanes, which the compiler turns into one SIMD register
+    for (size_t i = 0; i < 4; i++)
+    {
+        uint32_t x = this->state[i];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        this->state[i] = x;
+        bits[i] = x;
+    }
+}
+
+void retron::particles::random_t::fill(float* values, size_t count, float min_value, float max_value)
+{
+    const float scale = (max_value - min_value) / 16777216.0f;
+    std::array<uint32_t, 4> bits;
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        this->next(bits);
+
+        for (size_t j = 0, end = std::min<size_t>(4, count - i); j < end; j++)
+        {
+            values[i + j] = min_value + static_cast<float>(bits[j] >> 8) * scale;
+        }
+    }
+}
+
+void retron::particles::random_t::fill(int* values, size_t count, int min_value, int max_value)
+{
+    if (min_value > max_value)
+    {
+        std::swap(min_value, max_value);
+    }
+
+    const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max_value) - min_value + 1);
+    std::array<uint32_t, 4> bits;
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        this->next(bits);
+
+        for (size_t j = 0, end = std::min<size_t>(4, count - i); j < end; j++)
+        {
+            values[i + j] = min_value + static_cast<int>((bits[j] * range) >> 32);
+        }
+    }
+}
+
+void retron::particles::spawn_samples_t::resize(size_t count)
+{
+    this->angle.resize(count);
+    this->angle_vel.resize(count);
+    this->dist.resize(count);
+    this->dist_vel.resize(count);
+    this->size.resize(count);
+    this->spin.resize(count);
+    this->spin_vel.resize(count);
+    this->delay.resize(count);
+    this->life.resize(count);
+    this->pick.resize(count);
+}
+
+template<class RandomT>
+static void fill_fixed(RandomT& random, std::vector<float>& values, size_t count, const std::pair<ff::fixed_int, ff::fixed_int>& range)
+{
+    random.fill(values.data(), count, static_cast<float>(range.first), static_cast<float>(range.second));
+}
+
+size_t retron::particles::spec_t::add(particles& particles, retron::particles::random_t& random, ff::point_fixed pos, int effect_id, const retron::particle_effect_options& options) const
 {
     size_t max_life = 0;
 
-    const int count = ff::math::random_range(this->count);
-    if (count <= 0)
+    // Even a spawn thinned to nothing gets a group, so the effect is active until the next advance and then signals done
+    const int count = std::max(particles.budget_count(ff::math::random_range(this->count), this->priority), 0);
+    uint16_t group_id = particles.add_group(ff::pixel_transform(pos, scale * options.scale, rotate + options.rotate), effect_id, count, this->animations);
+    if (!count)
     {
         return max_life;
     }
 
-    uint16_t group_id = particles.add_group(ff::pixel_transform(pos, scale * options.scale, rotate + options.rotate), effect_id, count, this->animations);
+    const size_t pick_count = this->animations->size() ? this->animations->size() : this->colors.size();
+    const float spin_offset = static_cast<float>(options.spin);
+
+    retron::particles::spawn_samples_t& samples = particles.spawn_samples;
+    samples.resize(count);
+    ::fill_fixed(random, samples.angle, count, this->has_angle ? this->angle : options.angle);
+    ::fill_fixed(random, samples.angle_vel, count, this->angle_vel);
+    ::fill_fixed(random, samples.dist, count, this->dist);
+    ::fill_fixed(random, samples.dist_vel, count, this->dist_vel);
+    ::fill_fixed(random, samples.size, count, this->size);
+    ::fill_fixed(random, samples.spin, count, this->spin);
+    ::fill_fixed(random, samples.spin_vel, count, this->spin_vel);
+    random.fill(samples.delay.data(), count, this->delay.first, this->delay.second);
+    random.fill(samples.life.data(), count, this->life.first, this->life.second);
+    random.fill(samples.pick.data(), count, 0, std::max(static_cast<int>(pick_count) - 1, 0));
 
     for (int i = 0; i < count; i++)
     {
         retron::particles::particle_t p;
 
-        p.angle = ff::math::degrees_to_radians(static_cast<float>(ff::math::random_range(this->has_angle ? this->angle : options.angle)));
-        p.angle_vel = ff::math::degrees_to_radians(static_cast<float>(ff::math::random_range(this->angle_vel)));
-        p.dist = ff::math::random_range(this->dist);
-        p.dist_vel = ff::math::random_range(this->dist_vel);
+        p.angle = ff::math::degrees_to_radians(samples.angle[i]);
+        p.angle_vel = ff::math::degrees_to_radians(samples.angle_vel[i]);
+        p.dist = samples.dist[i];
+        p.dist_vel = samples.dist_vel[i];
 
-        p.size = ff::math::random_range(this->size);
-        p.spin = ff::math::random_range(this->spin) + options.spin;
-        p.spin_vel = ff::math::random_range(this->spin_vel);
+        p.size = samples.size[i];
+        p.spin = samples.spin[i] + spin_offset;
+        p.spin_vel = samples.spin_vel[i];
         p.timer = 0;
 
-        p.delay = ff::math::random_range(this->delay);
-        p.life = ff::math::random_range(this->life);
+        p.delay = static_cast<uint16_t>(samples.delay[i]);
+        p.life = static_cast<uint16_t>(samples.life[i]);
         p.type = options.type;
         p.internal_type = 0;
         p.group = group_id;
 
-        if (this->animations.size())
+        if (this->animations->size())
         {
-            const std::shared_ptr<ff::animation_base>& anim = this->animations[ff::math::random_range(0u, this->animations.size() - 1)];
-            p.animation(anim);
+            p.animation((*this->animations)[samples.pick[i]].get());
         }
         else
         {
             p.size /= 2.0f;
 
-            int color = this->colors.size() ? this->colors[ff::math::random_range(0u, this->colors.size() - 1)] : 0;
+            int color = this->colors.size() ? this->colors[samples.pick[i]] : 0;
             p.color(color);
         }
 
@@ -379,9 +973,12 @@ std::tuple<int, size_t> retron::particles::effect_t::add(particles& particles, c
     static retron::particle_effect_options default_options;
     options = options ? options : &default_options;
 
+    // The game's generator only seeds the effect, so replays still match. Two 16 bit halves don't depend on how wide its range is.
+    retron::particles::random_t random((ff::math::random_range(0u, 0xFFFFu) << 16) | ff::math::random_range(0u, 0xFFFFu));
+
     for (const spec_t& spec : this->specs)
     {
-        size_t life = spec.add(particles, *pos, effect_id, *options);
+        size_t life = spec.add(particles, random, *pos, effect_id, *options);
         max_life = std::max(max_life, life);
 
         if (pos_count > 1)
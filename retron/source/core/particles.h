@@ -1,5 +1,8 @@
 #pragma once
 
+#include "source/core/completion.h"
+#include "source/core/snapshot.h"
+
 namespace retron
 {
     struct particle_effect_options
@@ -16,6 +19,13 @@ namespace retron
     class particles
     {
     public:
+        struct stats_t
+        {
+            size_t peak_count; // most particles alive at once
+            size_t thinned_spawns; // spawns that got fewer particles because of the budget
+            size_t dropped_particles; // particles that were never spawned because of the budget
+        };
+
         particles();
 
         ff::end_scope_action advance_async();
@@ -25,7 +35,50 @@ namespace retron
         void effect_position(int effect_id, ff::point_fixed pos);
         ff::signal_sink<int>& effect_done_sink();
 
+        // Low priority effects only get part of the budget, so gameplay effects always have room
+        void budget(size_t max_count);
+        size_t budget() const;
+        const stats_t& stats() const;
+
+        // Must not be called while advancing
+        void save(retron::snapshot& snapshot) const;
+        void restore(retron::snapshot::reader& reader);
+
     private:
+        using animations_t = std::vector<std::shared_ptr<ff::animation_base>>;
+
+        // Fills random values for a whole spawn at once. Seeded from ff::math::random_range, so replays still match.
+        class random_t
+        {
+        public:
+            random_t(uint32_t seed);
+
+            void fill(float* values, size_t count, float min_value, float max_value);
+            void fill(int* values, size_t count, int min_value, int max_value); // inclusive, in either order
+
+        private:
+            void next(std::array<uint32_t, 4>& bits);
+
+            std::array<uint32_t, 4> state; // one xorshift per lane
+        };
+
+        // Random values for each particle of one spawn, reused between spawns
+        struct spawn_samples_t
+        {
+            void resize(size_t count);
+
+            std::vector<float> angle;
+            std::vector<float> angle_vel;
+            std::vector<float> dist;
+            std::vector<float> dist_vel;
+            std::vector<float> size;
+            std::vector<float> spin;
+            std::vector<float> spin_vel;
+            std::vector<int> delay;
+            std::vector<int> life;
+            std::vector<int> pick; // animation or color
+        };
+
         class spec_t
         {
         public:
@@ -37,7 +90,7 @@ namespace retron
             spec_t& operator=(retron::particles::spec_t&&) = default;
             spec_t& operator=(const retron::particles::spec_t&) = default;
 
-            size_t add(particles& particles, ff::point_fixed pos, int effect_id, const retron::particle_effect_options& options) const;
+            size_t add(particles& particles, retron::particles::random_t& random, ff::point_fixed pos, int effect_id, const retron::particle_effect_options& options) const;
 
         private:
             std::pair<int, int> count;
@@ -56,8 +109,9 @@ namespace retron
             ff::point_fixed scale;
 
             std::vector<int> colors;
-            std::vector<std::shared_ptr<ff::animation_base>> animations;
+            std::shared_ptr<const animations_t> animations; // shared with the groups that use it
 
+            int priority; // 0 is decorative, up to MAX_PRIORITY for effects that gameplay waits on
             bool reverse;
             bool has_angle;
         };
@@ -68,7 +122,13 @@ namespace retron
             ff::pixel_transform transform;
             int refs;
             int effect_id;
-            std::vector<std::shared_ptr<ff::animation_base>> animations;
+            uint16_t animations; // index into animation_lists
+        };
+
+        struct animation_list_t
+        {
+            std::shared_ptr<const animations_t> animations; // null once no group uses this slot
+            int groups; // live groups that point at this list
         };
 
         struct particle_t
@@ -84,9 +144,9 @@ namespace retron
                 this->color_ = color;
             }
 
-            void animation(std::shared_ptr<ff::animation_base> anim)
+            void animation(ff::animation_base* anim)
             {
-                this->anim = anim.get();
+                this->anim = anim;
             }
 
             // retron::position of particle within its group
@@ -114,18 +174,96 @@ namespace retron
             };
         };
 
+        // Ready to draw, so render doesn't have to do any math
+        struct instance_t
+        {
+            ff::point_float position;
+            float size;
+            float rotation;
+            float anim_frame;
+            int color;
+            ff::animation_base* anim; // null for colored particles
+        };
+
+        // Particles move linearly and never change after being added, so advancing works out where they are for the current frame
+        // and removes the ones whose time is up.
+        struct particle_buffer_t
+        {
+            size_t count() const;
+            void reserve(size_t count);
+            void resize(size_t count);
+            void push_back(const particle_t& p, uint32_t frame);
+            void push_back(const particle_buffer_t& source, size_t index);
+            void move(size_t from, size_t to);
+            void save(retron::snapshot& snapshot) const;
+            void restore(retron::snapshot::reader& reader);
+
+            std::vector<float> angle;
+            std::vector<float> angle_vel;
+            std::vector<float> dist;
+            std::vector<float> dist_vel;
+            std::vector<float> spin;
+            std::vector<float> spin_vel;
+            std::vector<float> size;
+            std::vector<uint32_t> start_frame; // visible and moving from here
+            std::vector<uint32_t> move_frames; // stops moving after this many frames
+            std::vector<uint32_t> end_frame; // removed here
+            std::vector<uint16_t> group;
+            std::vector<uint8_t> type;
+            std::vector<int> color;
+            std::vector<ff::animation_base*> anim; // null for colored particles
+            std::vector<instance_t> instance; // filled in by advancing, not valid for pending particles
+        };
+
+        // Each chunk of a bucket is checked by its own thread pool task
+        struct chunk_t
+        {
+            size_t bucket;
+            size_t start;
+            size_t end;
+            size_t keep_count;
+            std::vector<uint16_t> dead_groups;
+        };
+
         void advance_block();
-        void advance_now();
+        void advance_chunk(size_t chunk_index);
+        void compact_chunk(chunk_t& chunk);
+        void update_instance(particle_buffer_t& buffer, size_t index) const;
+        void update_group_matrices();
+        void merge_chunks();
+        void promote_pending();
+        particle_buffer_t& bucket(uint8_t type);
 
-        uint16_t add_group(const ff::pixel_transform& transform, int effect_id, int count, const std::vector<std::shared_ptr<ff::animation_base>>& animations);
+        uint16_t add_group(const ff::pixel_transform& transform, int effect_id, int count, const std::shared_ptr<const animations_t>& animations);
+        uint16_t animations_index(const std::shared_ptr<const animations_t>& animations);
+        void release_animations(uint16_t index);
         void release_group(uint16_t group_id);
-        const DirectX::XMFLOAT4X4& matrix(uint16_t group_id) const;
+        void release_dead_groups();
+        void free_group(uint16_t group_id, ff::stack_vector<int, 32>& effect_done);
+        void rebuild_group_index();
+        void update_live_count();
+        int budget_count(int count, int priority);
 
         std::vector<particle_t> particles_new;
-        std::vector<particle_t> particles_async;
-        std::vector<group_t> groups;
-        ff::win_handle async_event;
+        std::vector<particle_buffer_t> buckets; // started particles for each render type
+        particle_buffer_t pending; // particles still waiting for their delay
+        uint32_t frame;
+        std::vector<chunk_t> chunks;
+        std::atomic<size_t> chunks_remaining;
+        std::vector<group_t> groups; // only touched by the main thread
+        std::vector<DirectX::XMFLOAT4X4> group_matrices; // copied from groups for the worker tasks, which can't read groups while the level adds effects
+        std::vector<animation_list_t> animation_lists; // keeps animations alive for particles that point at them
+        std::vector<uint16_t> free_groups;
+        std::vector<uint16_t> finished_groups; // refs hit zero during the last advance
+        std::vector<ff::point_float> render_points; // colored particles are drawn as one list of triangles
+        std::vector<int> render_colors;
+        std::unordered_map<int, ff::stack_vector<uint16_t, 4>> effect_groups; // groups that are still alive for each effect
+        retron::completion async_done;
         ff::signal<int> effect_done_signal;
+        size_t budget_;
+        size_t live_count; // as of the last advance, doesn't include particles_new
+        stats_t stats_;
+        spawn_samples_t spawn_samples;
 
     public:
         class effect_t
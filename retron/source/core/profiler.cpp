@@ -0,0 +1,111 @@
+#include "pch.h"
+#include "source/core/profiler.h"
+
+namespace
+{
+    struct event_t
+    {
+        const char* name;
+        int64_t start;
+        int64_t duration;
+    };
+
+    // Each thread writes to its own ring, so recording never takes a lock
+    struct thread_events_t
+    {
+        std::array<event_t, 16384> events;
+        std::atomic<size_t> count;
+        size_t thread_index;
+    };
+}
+
+static std::atomic<bool> profiler_enabled;
+static std::mutex threads_mutex;
+static std::vector<std::unique_ptr<::thread_events_t>> threads;
+static thread_local ::thread_events_t* current_thread_events;
+
+static int64_t now_ns()
+{
+    static const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+static ::thread_events_t& thread_events()
+{
+    if (!::current_thread_events)
+    {
+        // Rings outlive their threads so the thread pool's events still get written
+        std::scoped_lock lock(::threads_mutex);
+        auto events = std::make_unique<::thread_events_t>();
+        events->count = 0;
+        events->thread_index = ::threads.size();
+        ::current_thread_events = events.get();
+        ::threads.push_back(std::move(events));
+    }
+
+    return *::current_thread_events;
+}
+
+retron::profiler::scope::scope(const char* name)
+    : name(::profiler_enabled.load(std::memory_order_relaxed) ? name : nullptr)
+    , start(this->name ? ::now_ns() : 0)
+{}
+
+retron::profiler::scope::~scope()
+{
+    if (this->name)
+    {
+        ::thread_events_t& events = ::thread_events();
+        size_t count = events.count.load(std::memory_order_relaxed);
+        events.events[count % events.events.size()] = ::event_t{ this->name, this->start, ::now_ns() - this->start };
+        events.count.store(count + 1, std::memory_order_release);
+    }
+}
+
+void retron::profiler::enabled(bool value)
+{
+    ::profiler_enabled = value;
+}
+
+bool retron::profiler::enabled()
+{
+    return ::profiler_enabled;
+}
+
+void retron::profiler::clear()
+{
+    std::scoped_lock lock(::threads_mutex);
+
+    for (auto& events : ::threads)
+    {
+        events->count = 0;
+    }
+}
+
+bool retron::profiler::write_chrome_trace(std::ostream& stream)
+{
+    std::scoped_lock lock(::threads_mutex);
+    const char* separator = "\n";
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    stream << std::fixed << std::setprecision(3);
+
+    for (auto& events : ::threads)
+    {
+        stream << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << events->thread_index
+            << ",\"args\":{\"name\":\"thread " << events->thread_index << "\"}}";
+        separator = ",\n";
+
+        // Timestamps are in microseconds
+        const size_t count = events->count.load(std::memory_order_acquire);
+        for (size_t i = (count > events->events.size()) ? count - events->events.size() : 0; i < count; i++)
+        {
+            const ::event_t& event = events->events[i % events->events.size()];
+            stream << separator << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << events->thread_index
+                << ",\"ts\":" << (event.start / 1000.0) << ",\"dur\":" << (event.duration / 1000.0) << "}";
+        }
+    }
+
+    stream << "\n]}\n";
+    return static_cast<bool>(stream);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+namespace retron::profiler
+{
+    // Times its own lifetime on the current thread, only costs a flag check while profiling is disabled
+    class scope
+    {
+    public:
+        scope(const char* name); // must stay valid until the trace is written, so use string literals
+        scope(const scope& other) = delete;
+        ~scope();
+
+        scope& operator=(const scope& other) = delete;
+
+    private:
+        const char* name;
+        int64_t start;
+    };
+
+    void enabled(bool value);
+    bool enabled();
+
+    // Only call these between frames, while no thread is inside a scope
+    void clear();
+    bool write_chrome_trace(std::ostream& stream);
+}
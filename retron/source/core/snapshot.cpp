@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "source/core/snapshot.h"
+
+retron::snapshot::reader::reader(const retron::snapshot& snapshot)
+    : snapshot(snapshot)
+    , pos(0)
+{}
+
+bool retron::snapshot::reader::done() const
+{
+    return this->pos >= this->snapshot.data.size();
+}
+
+void retron::snapshot::reader::read_bytes(void* data, size_t size)
+{
+    assert(this->pos + size <= this->snapshot.data.size());
+
+    if (size && this->pos + size <= this->snapshot.data.size())
+    {
+        std::memcpy(data, this->snapshot.data.data() + this->pos, size);
+        this->pos += size;
+    }
+}
+
+void retron::snapshot::clear()
+{
+    // Keeps capacity so that snapshots can be reused every frame without allocating
+    this->data.clear();
+    this->objects.clear();
+}
+
+bool retron::snapshot::empty() const
+{
+    return this->data.empty();
+}
+
+size_t retron::snapshot::byte_size() const
+{
+    return this->data.size();
+}
+
+void retron::snapshot::write_bytes(const void* data, size_t size)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    this->data.insert(this->data.end(), bytes, bytes + size);
+}
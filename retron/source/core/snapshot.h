@@ -0,0 +1,74 @@
+#pragma once
+
+namespace retron
+{
+    // Compact binary copy of game state. Shared objects are kept by reference, so they must not change after being written (copy mutable ones like animation players first).
+    class snapshot
+    {
+    public:
+        class reader
+        {
+        public:
+            reader(const retron::snapshot& snapshot);
+
+            template<class T> T read()
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                T value{};
+                this->read_bytes(&value, sizeof(T));
+                return value;
+            }
+
+            template<class T> void read(std::vector<T>& values)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                values.resize(this->read<size_t>());
+                this->read_bytes(values.data(), values.size() * sizeof(T));
+            }
+
+            template<class T> std::shared_ptr<T> read_object()
+            {
+                size_t index = this->read<size_t>();
+                assert(index < this->snapshot.objects.size());
+                return (index < this->snapshot.objects.size()) ? std::static_pointer_cast<T>(this->snapshot.objects[index]) : nullptr;
+            }
+
+            bool done() const;
+
+        private:
+            void read_bytes(void* data, size_t size);
+
+            const retron::snapshot& snapshot;
+            size_t pos;
+        };
+
+        void clear();
+        bool empty() const;
+        size_t byte_size() const;
+
+        template<class T> void write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            this->write_bytes(&value, sizeof(T));
+        }
+
+        template<class T> void write(const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            this->write(values.size());
+            this->write_bytes(values.data(), values.size() * sizeof(T));
+        }
+
+        template<class T> void write_object(const std::shared_ptr<T>& value)
+        {
+            this->write(this->objects.size());
+            this->objects.push_back(value);
+        }
+
+    private:
+        void write_bytes(const void* data, size_t size);
+
+        std::vector<uint8_t> data;
+        std::vector<std::shared_ptr<void>> objects;
+    };
+}
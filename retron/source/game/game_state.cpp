@@ -121,7 +121,10 @@ bool retron::game_state::player_take_life(const retron::player& level_player)
 
 void retron::game_state::debug_restart_level()
 {
-    this->init_playing_states();
+    if (!this->playing_states[this->playing_index].level->restart_instant())
+    {
+        this->init_playing_states();
+    }
 }
 
 void retron::game_state::init_input()
@@ -0,0 +1,165 @@
+#include "pch.h"
+#include "source/headless/benchmark.h"
+#include "source/headless/headless_host.h"
+#include "source/headless/recording_draw.h"
+#include "source/headless/stress_level.h"
+#include "source/level/entity_type.h"
+#include "source/level/level.h"
+
+namespace
+{
+    struct benchmark_level_t
+    {
+        std::string_view name;
+        retron::stress_level_params params;
+    };
+}
+
+static const ff::point_fixed SCREEN_LEVEL_SIZE(464, 250);
+
+static const std::array<::benchmark_level_t, 4> BENCHMARK_LEVELS
+{
+    ::benchmark_level_t{ "small"sv, { ::SCREEN_LEVEL_SIZE, 8, 4, 25, 5, 10, 10, 1 } },
+    ::benchmark_level_t{ "medium"sv, { ::SCREEN_LEVEL_SIZE, 16, 8, 100, 20, 30, 20, 1 } },
+    ::benchmark_level_t{ "large"sv, { ::SCREEN_LEVEL_SIZE, 24, 16, 250, 50, 60, 40, 1 } },
+    ::benchmark_level_t{ "maze_1k"sv, { ::SCREEN_LEVEL_SIZE * 2, 96, 32, 1000, 100, 150, 100, 1 } },
+};
+
+static double percentile(const std::vector<double>& sorted_times, double fraction)
+{
+    return sorted_times.size() ? sorted_times[static_cast<size_t>(fraction * (sorted_times.size() - 1))] : 0.0;
+}
+
+static std::unique_ptr<retron::headless_host> create_host(const ::benchmark_level_t& benchmark_level)
+{
+    retron::headless_params params{};
+    params.level_spec = std::make_shared<retron::level_spec>(retron::create_stress_level(benchmark_level.params));
+    params.seed = benchmark_level.params.seed;
+
+    auto host = std::make_unique<retron::headless_host>(params);
+    if (!host->valid())
+    {
+        std::cerr << "Invalid benchmark level: " << benchmark_level.name << "\n";
+        return nullptr;
+    }
+
+    // Nobody is steering the player, so keep it alive to measure the whole run
+    host->debug_cheats(retron::debug_cheats_t::invincible);
+    return host;
+}
+
+int retron::run_stress_benchmark(size_t frames, std::ostream& output)
+{
+    output << "level,entities,frames,p50_ms,p90_ms,p99_ms,max_ms\n";
+    output << std::fixed << std::setprecision(4);
+
+    for (const ::benchmark_level_t& benchmark_level : ::BENCHMARK_LEVELS)
+    {
+        std::unique_ptr<retron::headless_host> host_ptr = ::create_host(benchmark_level);
+        if (!host_ptr)
+        {
+            return 1;
+        }
+
+        retron::headless_host& host = *host_ptr;
+
+        std::vector<double> times;
+        times.reserve(frames);
+        size_t max_entities = 0;
+
+        while (times.size() < frames)
+        {
+            auto start_time = std::chrono::steady_clock::now();
+            bool more = host.advance();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_time;
+
+            times.push_back(elapsed.count());
+            max_entities = std::max(max_entities, host.level().host_registry().view<const retron::entity_type>().size());
+
+            if (!more)
+            {
+                break;
+            }
+        }
+
+        std::sort(times.begin(), times.end());
+
+        output << benchmark_level.name << ","
+            << max_entities << ","
+            << times.size() << ","
+            << ::percentile(times, 0.5) << ","
+            << ::percentile(times, 0.9) << ","
+            << ::percentile(times, 0.99) << ","
+            << (times.size() ? times.back() : 0.0) << "\n";
+    }
+
+    return 0;
+}
+
+int retron::run_render_benchmark(size_t frames, std::ostream& output)
+{
+    output << "level,entities,frames,draws,sprites,remap_pushes,texture_switches,remap_switches,state_changes,p50_ms,p99_ms\n";
+    output << std::fixed << std::setprecision(4);
+
+    retron::recording_draw draw;
+
+    for (const ::benchmark_level_t& benchmark_level : ::BENCHMARK_LEVELS)
+    {
+        std::unique_ptr<retron::headless_host> host_ptr = ::create_host(benchmark_level);
+        if (!host_ptr)
+        {
+            return 1;
+        }
+
+        retron::headless_host& host = *host_ptr;
+        retron::recording_draw::stats_t totals{};
+        std::vector<double> times;
+        times.reserve(frames);
+        size_t max_entities = 0;
+
+        while (times.size() < frames)
+        {
+            bool more = host.advance();
+
+            // Only building the list is timed, there's nothing to submit it to
+            auto start_time = std::chrono::steady_clock::now();
+            draw.begin();
+            host.level().render(draw);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_time;
+
+            const retron::recording_draw::stats_t& stats = draw.stats();
+            totals.draws += stats.draws;
+            totals.sprites += stats.sprites;
+            totals.remap_pushes += stats.remap_pushes;
+            totals.texture_switches += stats.texture_switches;
+            totals.remap_switches += stats.remap_switches;
+            totals.state_changes += stats.state_changes;
+
+            times.push_back(elapsed.count());
+            max_entities = std::max(max_entities, host.level().host_registry().view<const retron::entity_type>().size());
+
+            if (!more)
+            {
+                break;
+            }
+        }
+
+        std::sort(times.begin(), times.end());
+        const double frame_count = static_cast<double>(std::max<size_t>(times.size(), 1));
+
+        // Counts are per frame
+        output << benchmark_level.name << ","
+            << max_entities << ","
+            << times.size() << ","
+            << totals.draws / frame_count << ","
+            << totals.sprites / frame_count << ","
+            << totals.remap_pushes / frame_count << ","
+            << totals.texture_switches / frame_count << ","
+            << totals.remap_switches / frame_count << ","
+            << totals.state_changes / frame_count << ","
+            << ::percentile(times, 0.5) << ","
+            << ::percentile(times, 0.99) << "\n";
+    }
+
+    return 0;
+}
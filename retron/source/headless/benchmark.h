@@ -0,0 +1,10 @@
+#pragma once
+
+namespace retron
+{
+    // Runs generated levels of growing size headlessly and reports frame time percentiles for each
+    int run_stress_benchmark(size_t frames, std::ostream& output);
+
+    // Renders the same levels into a recording draw target and reports what each frame submits
+    int run_render_benchmark(size_t frames, std::ostream& output);
+}
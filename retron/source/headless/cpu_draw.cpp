@@ -0,0 +1,565 @@
+#include "pch.h"
+#include "source/headless/cpu_draw.h"
+
+static const size_t CIRCLE_SEGMENTS = 32;
+
+static int color_to_index(const DirectX::XMFLOAT4& color)
+{
+    // RGB draws only happen with colors made by ff::palette_index_to_color, so find the index that made it
+    static const std::array<float, 256> index_reds = []()
+        {
+            std::array<float, 256> reds;
+            for (int i = 0; i < 256; i++)
+            {
+                reds[i] = ff::palette_index_to_color(i).x;
+            }
+
+            return reds;
+        }();
+
+    auto i = std::lower_bound(index_reds.begin(), index_reds.end(), color.x);
+    if (i == index_reds.end() || (i != index_reds.begin() && color.x - *(i - 1) < *i - color.x))
+    {
+        i--;
+    }
+
+    return (color.w > 0.0f) ? static_cast<int>(i - index_reds.begin()) : 0;
+}
+
+template<class ImageT>
+static bool palette_image(const ff::sprite_data& sprite, ImageT& image)
+{
+    // The only place that knows about textures. They keep their original pixels, and only palette index textures can be drawn.
+    ff::dx11_texture* texture = sprite.view() ? sprite.view()->view_texture() : nullptr;
+    const std::shared_ptr<DirectX::ScratchImage>& data = texture ? texture->data() : nullptr;
+    const DirectX::Image* data_image = data ? data->GetImage(0, 0, 0) : nullptr;
+
+    if (!data_image || data_image->format != DXGI_FORMAT_R8_UINT)
+    {
+        return false;
+    }
+
+    image.pixels = data_image->pixels;
+    image.row_pitch = data_image->rowPitch;
+    image.width = data_image->width;
+    image.height = data_image->height;
+    return true;
+}
+
+static float edge(const ff::point_float& a, const ff::point_float& b, float x, float y)
+{
+    return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+retron::cpu_draw::cpu_draw(ff::point_int size)
+    : size_(size)
+    , pixels_(static_cast<size_t>(size.x * size.y))
+    , band_rows(static_cast<size_t>(size.y))
+    , bands_remaining(0)
+{
+    this->commands.reserve(4096);
+}
+
+void retron::cpu_draw::begin(uint8_t clear_index)
+{
+    std::fill(this->pixels_.begin(), this->pixels_.end(), clear_index);
+    this->commands.clear();
+    this->remaps.clear();
+}
+
+void retron::cpu_draw::end(size_t band_count)
+{
+    band_count = std::clamp<size_t>(band_count, 1, static_cast<size_t>(this->size_.y));
+    this->band_rows = (this->size_.y + band_count - 1) / band_count;
+
+    if (band_count == 1)
+    {
+        this->render_band(0);
+        return;
+    }
+
+    // Bands never share rows, so each one runs through every command on its own
+    this->bands_remaining = band_count;
+
+    for (size_t i = 0; i < band_count; i++)
+    {
+        ff::thread_pool::get()->add_task([this, i]()
+            {
+                this->render_band(i);
+
+                if (this->bands_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    this->bands_done.set();
+                }
+            });
+    }
+
+    this->bands_done.wait_and_reset();
+}
+
+ff::point_int retron::cpu_draw::size() const
+{
+    return this->size_;
+}
+
+const std::vector<uint8_t>& retron::cpu_draw::pixels() const
+{
+    return this->pixels_;
+}
+
+size_t retron::cpu_draw::command_count() const
+{
+    return this->commands.size();
+}
+
+bool retron::cpu_draw::write_pgm(std::ostream& output) const
+{
+    output << "P5\n" << this->size_.x << " " << this->size_.y << "\n255\n";
+    output.write(reinterpret_cast<const char*>(this->pixels_.data()), this->pixels_.size());
+    return output.good();
+}
+
+std::optional<size_t> retron::cpu_draw::compare_pgm(std::istream& input) const
+{
+    // Only reads what write_pgm writes
+    std::string magic;
+    int width = 0, height = 0, max_value = 0;
+    if (!(input >> magic >> width >> height >> max_value) || magic != "P5" || width != this->size_.x || height != this->size_.y || max_value != 255 || input.get() != '\n')
+    {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> golden(this->pixels_.size());
+    if (!input.read(reinterpret_cast<char*>(golden.data()), golden.size()))
+    {
+        return std::nullopt;
+    }
+
+    size_t diff_count = 0;
+    for (size_t i = 0; i < golden.size(); i++)
+    {
+        diff_count += (golden[i] != this->pixels_[i]);
+    }
+
+    return diff_count;
+}
+
+void retron::cpu_draw::draw_sprite(const ff::sprite_data& sprite, const ff::transform& transform)
+{
+    image_t image;
+    if (!::palette_image(sprite, image))
+    {
+        return;
+    }
+
+    DirectX::XMMATRIX matrix = transform.matrix();
+    DirectX::XMFLOAT4X4 inverse;
+    DirectX::XMStoreFloat4x4(&inverse, DirectX::XMMatrixInverse(nullptr, matrix));
+
+    command_t command{};
+    command.type = command_type::sprite;
+    command.world = sprite.world();
+    command.uv = sprite.texture_uv();
+    command.image = image;
+    command.remap = this->remaps.size() ? this->remaps.back() : nullptr;
+    command.inverse = { inverse._11, inverse._12, inverse._21, inverse._22, inverse._41, inverse._42 };
+
+    const std::array<ff::point_float, 4> corners
+    {
+        command.world.top_left(), command.world.top_right(), command.world.bottom_left(), command.world.bottom_right(),
+    };
+
+    command.bounds = ff::rect_float(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+
+    for (const ff::point_float& corner : corners)
+    {
+        DirectX::XMFLOAT2 pos;
+        DirectX::XMStoreFloat2(&pos, DirectX::XMVector2Transform(DirectX::XMVectorSet(corner.x, corner.y, 0, 0), matrix));
+        command.bounds.left = std::min(command.bounds.left, pos.x);
+        command.bounds.top = std::min(command.bounds.top, pos.y);
+        command.bounds.right = std::max(command.bounds.right, pos.x);
+        command.bounds.bottom = std::max(command.bounds.bottom, pos.y);
+    }
+
+    this->commands.push_back(command);
+}
+
+void retron::cpu_draw::draw_line_strip(const ff::point_float* points, const DirectX::XMFLOAT4* colors, size_t count, float thickness, bool pixel_thickness)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        this->add_line(points[i - 1], points[i], ::color_to_index(colors[i - 1]), thickness);
+    }
+}
+
+void retron::cpu_draw::draw_line_strip(const ff::point_float* points, size_t count, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        this->add_line(points[i - 1], points[i], ::color_to_index(color), thickness);
+    }
+}
+
+void retron::cpu_draw::draw_line(const ff::point_float& start, const ff::point_float& end, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness)
+{
+    this->add_line(start, end, ::color_to_index(color), thickness);
+}
+
+void retron::cpu_draw::draw_filled_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4* colors)
+{
+    this->add_rectangle(rect, ::color_to_index(colors[0]));
+}
+
+void retron::cpu_draw::draw_filled_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4& color)
+{
+    this->add_rectangle(rect, ::color_to_index(color));
+}
+
+void retron::cpu_draw::draw_filled_triangles(const ff::point_float* points, const DirectX::XMFLOAT4* colors, size_t count)
+{
+    for (size_t i = 0; i < count; i++, points += 3, colors += 3)
+    {
+        this->add_triangle(points[0], points[1], points[2], ::color_to_index(colors[0]));
+    }
+}
+
+void retron::cpu_draw::draw_filled_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& color)
+{
+    this->add_circle(center, radius, 0, ::color_to_index(color));
+}
+
+void retron::cpu_draw::draw_filled_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& inside_color, const DirectX::XMFLOAT4& outside_color)
+{
+    this->add_circle(center, radius, 0, ::color_to_index(inside_color));
+}
+
+void retron::cpu_draw::draw_outline_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness)
+{
+    this->draw_palette_outline_rectangle(rect, ::color_to_index(color), thickness, pixel_thickness);
+}
+
+void retron::cpu_draw::draw_outline_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness)
+{
+    this->add_circle(center, radius, thickness, ::color_to_index(color));
+}
+
+void retron::cpu_draw::draw_outline_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& inside_color, const DirectX::XMFLOAT4& outside_color, float thickness, bool pixel_thickness)
+{
+    this->add_circle(center, radius, thickness, ::color_to_index(inside_color));
+}
+
+void retron::cpu_draw::draw_palette_line_strip(const ff::point_float* points, const int* colors, size_t count, float thickness, bool pixel_thickness)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        this->add_line(points[i - 1], points[i], colors[i - 1], thickness);
+    }
+}
+
+void retron::cpu_draw::draw_palette_line_strip(const ff::point_float* points, size_t count, int color, float thickness, bool pixel_thickness)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        this->add_line(points[i - 1], points[i], color, thickness);
+    }
+}
+
+void retron::cpu_draw::draw_palette_line(const ff::point_float& start, const ff::point_float& end, int color, float thickness, bool pixel_thickness)
+{
+    this->add_line(start, end, color, thickness);
+}
+
+void retron::cpu_draw::draw_palette_filled_rectangle(const ff::rect_float& rect, const int* colors)
+{
+    this->add_rectangle(rect, colors[0]);
+}
+
+void retron::cpu_draw::draw_palette_filled_rectangle(const ff::rect_float& rect, int color)
+{
+    this->add_rectangle(rect, color);
+}
+
+void retron::cpu_draw::draw_palette_filled_triangles(const ff::point_float* points, const int* colors, size_t count)
+{
+    for (size_t i = 0; i < count; i++, points += 3, colors += 3)
+    {
+        this->add_triangle(points[0], points[1], points[2], colors[0]);
+    }
+}
+
+void retron::cpu_draw::draw_palette_filled_circle(const ff::point_float& center, float radius, int color)
+{
+    this->add_circle(center, radius, 0, color);
+}
+
+void retron::cpu_draw::draw_palette_filled_circle(const ff::point_float& center, float radius, int inside_color, int outside_color)
+{
+    this->add_circle(center, radius, 0, inside_color);
+}
+
+void retron::cpu_draw::draw_palette_outline_rectangle(const ff::rect_float& rect, int color, float thickness, bool pixel_thickness)
+{
+    // Thickness is centered on the edges, like the GPU version
+    const ff::rect_float outer = rect.inflate(thickness / 2, thickness / 2);
+    const ff::rect_float inner = rect.deflate(thickness / 2, thickness / 2);
+
+    this->add_rectangle(ff::rect_float(outer.left, outer.top, outer.right, inner.top), color);
+    this->add_rectangle(ff::rect_float(outer.left, inner.bottom, outer.right, outer.bottom), color);
+    this->add_rectangle(ff::rect_float(outer.left, inner.top, inner.left, inner.bottom), color);
+    this->add_rectangle(ff::rect_float(inner.right, inner.top, outer.right, inner.bottom), color);
+}
+
+void retron::cpu_draw::draw_palette_outline_circle(const ff::point_float& center, float radius, int color, float thickness, bool pixel_thickness)
+{
+    this->add_circle(center, radius, thickness, color);
+}
+
+void retron::cpu_draw::draw_palette_outline_circle(const ff::point_float& center, float radius, int inside_color, int outside_color, float thickness, bool pixel_thickness)
+{
+    this->add_circle(center, radius, thickness, inside_color);
+}
+
+ff::matrix_stack& retron::cpu_draw::world_matrix_stack()
+{
+    // Nothing in retron pushes world transforms while drawing palette content, so they aren't applied
+    return this->world_matrix_stack_;
+}
+
+void retron::cpu_draw::nudge_depth()
+{}
+
+void retron::cpu_draw::push_palette(ff::palette_base* palette)
+{}
+
+void retron::cpu_draw::pop_palette()
+{}
+
+void retron::cpu_draw::push_palette_remap(const uint8_t* remap, size_t hash)
+{
+    this->remaps.push_back(remap);
+}
+
+void retron::cpu_draw::pop_palette_remap()
+{
+    assert(this->remaps.size());
+    this->remaps.pop_back();
+}
+
+void retron::cpu_draw::push_no_overlap()
+{}
+
+void retron::cpu_draw::pop_no_overlap()
+{}
+
+void retron::cpu_draw::push_opaque()
+{}
+
+void retron::cpu_draw::pop_opaque()
+{}
+
+void retron::cpu_draw::push_pre_multiplied_alpha()
+{}
+
+void retron::cpu_draw::pop_pre_multiplied_alpha()
+{}
+
+void retron::cpu_draw::push_custom_context(ff::draw_base::custom_context_func&& func)
+{}
+
+void retron::cpu_draw::pop_custom_context()
+{}
+
+void retron::cpu_draw::push_texture_sampler(D3D11_FILTER filter)
+{}
+
+void retron::cpu_draw::pop_texture_sampler()
+{}
+
+uint8_t retron::cpu_draw::remap(int color) const
+{
+    const uint8_t index = static_cast<uint8_t>(color);
+    return this->remaps.size() && this->remaps.back() ? this->remaps.back()[index] : index;
+}
+
+void retron::cpu_draw::add_rectangle(const ff::rect_float& rect, int color)
+{
+    command_t command{};
+    command.type = command_type::rectangle;
+    command.color = this->remap(color);
+    command.bounds = rect.normalize();
+    this->commands.push_back(command);
+}
+
+void retron::cpu_draw::add_triangle(const ff::point_float& a, const ff::point_float& b, const ff::point_float& c, int color)
+{
+    command_t command{};
+    command.type = command_type::triangle;
+    command.color = this->remap(color);
+    command.points = { a, b, c };
+    command.bounds = ff::rect_float(
+        std::min({ a.x, b.x, c.x }), std::min({ a.y, b.y, c.y }),
+        std::max({ a.x, b.x, c.x }), std::max({ a.y, b.y, c.y }));
+    this->commands.push_back(command);
+}
+
+void retron::cpu_draw::add_line(const ff::point_float& start, const ff::point_float& end, int color, float thickness)
+{
+    const ff::point_float delta = end - start;
+    const float length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+    if (length <= 0.0f)
+    {
+        return;
+    }
+
+    // A quad around the line, made of two triangles
+    const ff::point_float normal = ff::point_float(-delta.y, delta.x) * (std::max(thickness, 1.0f) / 2.0f / length);
+    this->add_triangle(start + normal, end + normal, end - normal, color);
+    this->add_triangle(start + normal, end - normal, start - normal, color);
+}
+
+void retron::cpu_draw::add_circle(const ff::point_float& center, float radius, float thickness, int color)
+{
+    const float outer_radius = (thickness > 0.0f) ? radius + thickness / 2.0f : radius;
+    const float inner_radius = (thickness > 0.0f) ? std::max(radius - thickness / 2.0f, 0.0f) : 0.0f;
+    ff::point_float outer_prev(center.x + outer_radius, center.y);
+    ff::point_float inner_prev(center.x + inner_radius, center.y);
+
+    for (size_t i = 1; i <= ::CIRCLE_SEGMENTS; i++)
+    {
+        const float angle = DirectX::XM_2PI * i / ::CIRCLE_SEGMENTS;
+        const ff::point_float dir(std::cos(angle), std::sin(angle));
+        const ff::point_float outer = center + dir * outer_radius;
+        const ff::point_float inner = center + dir * inner_radius;
+
+        this->add_triangle(outer_prev, outer, inner, color);
+
+        if (inner_radius > 0.0f)
+        {
+            this->add_triangle(outer_prev, inner, inner_prev, color);
+        }
+
+        outer_prev = outer;
+        inner_prev = inner;
+    }
+}
+
+void retron::cpu_draw::render_band(size_t band_index)
+{
+    const int y_start = static_cast<int>(band_index * this->band_rows);
+    const int y_end = std::min(static_cast<int>((band_index + 1) * this->band_rows), this->size_.y);
+
+    for (const command_t& command : this->commands)
+    {
+        if (command.bounds.bottom <= y_start || command.bounds.top >= y_end)
+        {
+            continue;
+        }
+
+        switch (command.type)
+        {
+            case command_type::rectangle:
+                this->render_rectangle(command, y_start, y_end);
+                break;
+
+            case command_type::triangle:
+                this->render_triangle(command, y_start, y_end);
+                break;
+
+            case command_type::sprite:
+                this->render_sprite(command, y_start, y_end);
+                break;
+        }
+    }
+}
+
+void retron::cpu_draw::render_rectangle(const command_t& command, int y_start, int y_end)
+{
+    // A pixel is covered when its center is inside
+    const int left = std::max(static_cast<int>(std::ceil(command.bounds.left - 0.5f)), 0);
+    const int right = std::min(static_cast<int>(std::ceil(command.bounds.right - 0.5f)), this->size_.x);
+    const int top = std::max(static_cast<int>(std::ceil(command.bounds.top - 0.5f)), y_start);
+    const int bottom = std::min(static_cast<int>(std::ceil(command.bounds.bottom - 0.5f)), y_end);
+
+    for (int y = top; y < bottom && left < right; y++)
+    {
+        std::fill_n(&this->pixels_[static_cast<size_t>(y * this->size_.x + left)], right - left, command.color);
+    }
+}
+
+void retron::cpu_draw::render_triangle(const command_t& command, int y_start, int y_end)
+{
+    const ff::point_float& a = command.points[0];
+    const ff::point_float& b = command.points[1];
+    const ff::point_float& c = command.points[2];
+    const float area = ::edge(a, b, c.x, c.y);
+    if (area == 0.0f)
+    {
+        return;
+    }
+
+    const float sign = (area > 0.0f) ? 1.0f : -1.0f;
+    const int left = std::max(static_cast<int>(std::floor(command.bounds.left)), 0);
+    const int right = std::min(static_cast<int>(std::ceil(command.bounds.right)), this->size_.x);
+    const int top = std::max(static_cast<int>(std::floor(command.bounds.top)), y_start);
+    const int bottom = std::min(static_cast<int>(std::ceil(command.bounds.bottom)), y_end);
+
+    for (int y = top; y < bottom; y++)
+    {
+        uint8_t* row = &this->pixels_[static_cast<size_t>(y * this->size_.x)];
+        const float py = y + 0.5f;
+
+        for (int x = left; x < right; x++)
+        {
+            const float px = x + 0.5f;
+            if (sign * ::edge(a, b, px, py) >= 0.0f && sign * ::edge(b, c, px, py) >= 0.0f && sign * ::edge(c, a, px, py) >= 0.0f)
+            {
+                row[x] = command.color;
+            }
+        }
+    }
+}
+
+void retron::cpu_draw::render_sprite(const command_t& command, int y_start, int y_end)
+{
+    const image_t& image = command.image;
+    const std::array<float, 6>& m = command.inverse;
+    const float world_width = command.world.width();
+    const float world_height = command.world.height();
+    const int left = std::max(static_cast<int>(std::floor(command.bounds.left)), 0);
+    const int right = std::min(static_cast<int>(std::ceil(command.bounds.right)), this->size_.x);
+    const int top = std::max(static_cast<int>(std::floor(command.bounds.top)), y_start);
+    const int bottom = std::min(static_cast<int>(std::ceil(command.bounds.bottom)), y_end);
+
+    if (world_width <= 0.0f || world_height <= 0.0f)
+    {
+        return;
+    }
+
+    for (int y = top; y < bottom; y++)
+    {
+        uint8_t* row = &this->pixels_[static_cast<size_t>(y * this->size_.x)];
+        const float py = y + 0.5f;
+
+        for (int x = left; x < right; x++)
+        {
+            // Back into sprite space, then nearest texel, and index zero is transparent
+            const float px = x + 0.5f;
+            const float sx = px * m[0] + py * m[2] + m[4];
+            const float sy = px * m[1] + py * m[3] + m[5];
+            const float u = (sx - command.world.left) / world_width;
+            const float v = (sy - command.world.top) / world_height;
+
+            if (u >= 0.0f && u < 1.0f && v >= 0.0f && v < 1.0f)
+            {
+                const size_t tx = static_cast<size_t>((command.uv.left + u * command.uv.width()) * image.width);
+                const size_t ty = static_cast<size_t>((command.uv.top + v * command.uv.height()) * image.height);
+                const uint8_t index = image.pixels[std::min(ty, image.height - 1) * image.row_pitch + std::min(tx, image.width - 1)];
+
+                if (index)
+                {
+                    row[x] = command.remap ? command.remap[index] : index;
+                }
+            }
+        }
+    }
+}
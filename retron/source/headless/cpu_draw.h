@@ -0,0 +1,122 @@
+#pragma once
+
+#include "source/core/completion.h"
+
+namespace retron
+{
+    // Draws into an 8-bit palette index buffer on the CPU, so levels can render without a GPU.
+    // Draw calls are only recorded, end() rasterizes them and can split the rows between threads.
+    class cpu_draw : public ff::draw_base
+    {
+    public:
+        cpu_draw(ff::point_int size);
+        cpu_draw(const cpu_draw& other) = delete;
+
+        cpu_draw& operator=(const cpu_draw& other) = delete;
+
+        void begin(uint8_t clear_index = 0);
+        void end(size_t band_count = 1);
+
+        ff::point_int size() const;
+        const std::vector<uint8_t>& pixels() const;
+        size_t command_count() const;
+        bool write_pgm(std::ostream& output) const; // palette indexes as gray levels, for golden images
+        std::optional<size_t> compare_pgm(std::istream& input) const; // pixels that differ from a golden image, nullopt if it can't be read or has another size
+
+        // ff::draw_base
+        virtual void draw_sprite(const ff::sprite_data& sprite, const ff::transform& transform) override;
+
+        virtual void draw_line_strip(const ff::point_float* points, const DirectX::XMFLOAT4* colors, size_t count, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_line_strip(const ff::point_float* points, size_t count, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_line(const ff::point_float& start, const ff::point_float& end, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_filled_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4* colors) override;
+        virtual void draw_filled_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4& color) override;
+        virtual void draw_filled_triangles(const ff::point_float* points, const DirectX::XMFLOAT4* colors, size_t count) override;
+        virtual void draw_filled_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& color) override;
+        virtual void draw_filled_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& inside_color, const DirectX::XMFLOAT4& outside_color) override;
+        virtual void draw_outline_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_outline_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_outline_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& inside_color, const DirectX::XMFLOAT4& outside_color, float thickness, bool pixel_thickness = false) override;
+
+        virtual void draw_palette_line_strip(const ff::point_float* points, const int* colors, size_t count, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_palette_line_strip(const ff::point_float* points, size_t count, int color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_palette_line(const ff::point_float& start, const ff::point_float& end, int color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_palette_filled_rectangle(const ff::rect_float& rect, const int* colors) override;
+        virtual void draw_palette_filled_rectangle(const ff::rect_float& rect, int color) override;
+        virtual void draw_palette_filled_triangles(const ff::point_float* points, const int* colors, size_t count) override;
+        virtual void draw_palette_filled_circle(const ff::point_float& center, float radius, int color) override;
+        virtual void draw_palette_filled_circle(const ff::point_float& center, float radius, int inside_color, int outside_color) override;
+        virtual void draw_palette_outline_rectangle(const ff::rect_float& rect, int color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_palette_outline_circle(const ff::point_float& center, float radius, int color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_palette_outline_circle(const ff::point_float& center, float radius, int inside_color, int outside_color, float thickness, bool pixel_thickness = false) override;
+
+        virtual ff::matrix_stack& world_matrix_stack() override;
+        virtual void nudge_depth() override;
+
+        virtual void push_palette(ff::palette_base* palette) override;
+        virtual void pop_palette() override;
+        virtual void push_palette_remap(const uint8_t* remap, size_t hash) override;
+        virtual void pop_palette_remap() override;
+        virtual void push_no_overlap() override;
+        virtual void pop_no_overlap() override;
+        virtual void push_opaque() override;
+        virtual void pop_opaque() override;
+        virtual void push_pre_multiplied_alpha() override;
+        virtual void pop_pre_multiplied_alpha() override;
+        virtual void push_custom_context(ff::draw_base::custom_context_func&& func) override;
+        virtual void pop_custom_context() override;
+        virtual void push_texture_sampler(D3D11_FILTER filter) override;
+        virtual void pop_texture_sampler() override;
+
+    private:
+        enum class command_type : uint8_t
+        {
+            rectangle,
+            triangle,
+            sprite,
+        };
+
+        // Palette index texels, the only part of a texture that's needed
+        struct image_t
+        {
+            const uint8_t* pixels;
+            size_t row_pitch;
+            size_t width;
+            size_t height;
+        };
+
+        struct command_t
+        {
+            command_type type;
+            uint8_t color; // already remapped, unused by sprites
+            ff::rect_float bounds;
+            std::array<ff::point_float, 3> points; // triangle
+            std::array<float, 6> inverse; // sprite, from screen to sprite space
+            ff::rect_float world; // sprite space rect
+            ff::rect_float uv;
+            image_t image;
+            const uint8_t* remap;
+        };
+
+        uint8_t remap(int color) const;
+        void add_rectangle(const ff::rect_float& rect, int color);
+        void add_triangle(const ff::point_float& a, const ff::point_float& b, const ff::point_float& c, int color);
+        void add_line(const ff::point_float& start, const ff::point_float& end, int color, float thickness);
+        void add_circle(const ff::point_float& center, float radius, float thickness, int color); // thickness <= 0 for filled
+
+        void render_band(size_t band_index);
+        void render_rectangle(const command_t& command, int y_start, int y_end);
+        void render_triangle(const command_t& command, int y_start, int y_end);
+        void render_sprite(const command_t& command, int y_start, int y_end);
+
+        ff::point_int size_;
+        std::vector<uint8_t> pixels_;
+        std::vector<command_t> commands;
+        std::vector<const uint8_t*> remaps;
+        ff::matrix_stack world_matrix_stack_;
+
+        size_t band_rows;
+        std::atomic<size_t> bands_remaining;
+        retron::completion bands_done;
+    };
+}
@@ -0,0 +1,57 @@
+#include "pch.h"
+#include "source/headless/draw_test.h"
+
+void retron::draw_test_scene(ff::draw_base& draw)
+{
+    // Rectangles, on and off pixel centers, overlapping in draw order
+    draw.draw_palette_filled_rectangle(ff::rect_float(8, 8, 72, 48), 10);
+    draw.draw_palette_filled_rectangle(ff::rect_float(40.3f, 24.7f, 100.6f, 64.2f), 20);
+    draw.draw_palette_outline_rectangle(ff::rect_float(112, 8, 184, 64), 30, 2);
+    draw.draw_palette_outline_rectangle(ff::rect_float(120.5f, 16.5f, 176.5f, 56.5f), 31, 1);
+
+    // Triangles in both windings
+    const std::array<ff::point_float, 6> triangles
+    {
+        ff::point_float(200, 8), ff::point_float(260, 64), ff::point_float(200, 64),
+        ff::point_float(270, 8), ff::point_float(270.5f, 64), ff::point_float(330.25f, 20.75f),
+    };
+
+    const std::array<int, 6> triangle_colors{ 40, 40, 40, 41, 41, 41 };
+    draw.draw_palette_filled_triangles(triangles.data(), triangle_colors.data(), 2);
+
+    // Lines of different thickness and slope
+    draw.draw_palette_line(ff::point_float(8, 80), ff::point_float(230, 130), 50, 1);
+    draw.draw_palette_line(ff::point_float(8, 140), ff::point_float(230, 90), 51, 3);
+    draw.draw_palette_line(ff::point_float(240, 80), ff::point_float(240, 140), 52, 2);
+
+    const std::array<ff::point_float, 4> strip{ ff::point_float(260, 140), ff::point_float(300, 80), ff::point_float(340, 140), ff::point_float(380, 80) };
+    draw.draw_palette_line_strip(strip.data(), strip.size(), 53, 1.5f);
+
+    // Circles
+    draw.draw_palette_filled_circle(ff::point_float(60, 200), 40, 60);
+    draw.draw_palette_outline_circle(ff::point_float(160, 200), 40, 61, 4);
+    draw.draw_palette_outline_circle(ff::point_float(160, 200), 20.5f, 62, 1);
+
+    // Remapped colors, and a remap inside another one
+    std::array<uint8_t, 256> remap;
+    std::array<uint8_t, 256> remap2;
+
+    for (size_t i = 0; i < remap.size(); i++)
+    {
+        remap[i] = static_cast<uint8_t>(255 - i);
+        remap2[i] = static_cast<uint8_t>(i + 100);
+    }
+
+    draw.push_palette_remap(remap.data(), 1);
+    draw.draw_palette_filled_rectangle(ff::rect_float(240, 160, 300, 240), 5);
+    draw.push_palette_remap(remap2.data(), 2);
+    draw.draw_palette_filled_circle(ff::point_float(300, 200), 30, 6);
+    draw.pop_palette_remap();
+    draw.draw_palette_filled_rectangle(ff::rect_float(320, 200, 360, 260), 7);
+    draw.pop_palette_remap();
+
+    // Clipped at the edges
+    draw.draw_palette_filled_circle(ff::point_float(470, 10), 30, 70);
+    draw.draw_palette_filled_rectangle(ff::rect_float(-10, 250, 30, 290), 71);
+    draw.draw_palette_line(ff::point_float(400, 290), ff::point_float(500, 150), 72, 2);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+namespace retron
+{
+    // Draws a fixed set of palette shapes that don't need any resources. The result is checked in as a golden image,
+    // so changes to the CPU rasterizer show up as pixel differences.
+    void draw_test_scene(ff::draw_base& draw);
+}
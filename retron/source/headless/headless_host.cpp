@@ -0,0 +1,334 @@
+#include "pch.h"
+#include "source/headless/headless_host.h"
+#include "source/level/level.h"
+
+[[noreturn]] static void not_available()
+{
+    // Nothing that renders or plays audio runs headless
+    assert(false);
+    std::abort();
+}
+
+retron::headless_host::headless_host(const retron::headless_params& params)
+    : game_spec_(retron::game_spec::load())
+    , difficulty_spec_{}
+    , player_{}
+    , palette_data("palette_main")
+    , input_mapping("player_controls")
+    , replay(params.replay)
+    , debug_cheats_(retron::debug_cheats_t::none)
+    , frame_count_(0)
+    , valid_(false)
+{
+    auto diff = this->game_spec_.difficulties.find(params.difficulty_id.size() ? params.difficulty_id : std::string(this->game_options_.difficulty_id()));
+    if (diff == this->game_spec_.difficulties.end())
+    {
+        return;
+    }
+
+    this->difficulty_spec_ = diff->second;
+
+    std::string level_id = params.level_id;
+    if (level_id.empty())
+    {
+        auto level_set = this->game_spec_.level_sets.find(this->difficulty_spec_.level_set);
+        if (level_set != this->game_spec_.level_sets.end() && level_set->second.levels.size())
+        {
+            level_id = level_set->second.levels.front();
+        }
+    }
+
+    const retron::level_spec* level_spec = params.level_spec.get();
+    if (!level_spec)
+    {
+        auto i = this->game_spec_.levels.find(level_id);
+        if (i == this->game_spec_.levels.end())
+        {
+            return;
+        }
+
+        level_spec = &i->second;
+    }
+
+    if (params.input_path.size())
+    {
+        std::ifstream script(params.input_path);
+        this->input_device = retron::headless_input(script);
+
+        if (!script.eof() || !this->input_device.valid())
+        {
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < this->player_palettes.size(); i++)
+    {
+        this->player_palettes[i] = retron::helpers::create_player_palette(this->palette_data.object(), i);
+    }
+
+    this->input_events_ = std::make_unique<ff::input_event_provider>(*this->input_mapping.object(), std::vector<const ff::input_vk*>{ &this->input_device });
+
+    this->player_.lives = this->difficulty_spec_.lives ? (this->difficulty_spec_.lives - 1) : 0;
+    this->player_.next_life_points = this->difficulty_spec_.first_free_life;
+
+    // Levels place enemies randomly, so the generator must start the same way for a replay to match
+    retron::helpers::seed_random(params.seed);
+    this->recording_ = retron::replay(params.seed, diff->first, level_id);
+
+    this->level_ = std::make_shared<retron::level>(*this, *level_spec, std::vector<const retron::player*>{ &this->player_ });
+    this->valid_ = true;
+}
+
+retron::headless_host::~headless_host()
+{
+    // The level is connected to signals owned by this host
+    this->level_.reset();
+}
+
+bool retron::headless_host::valid() const
+{
+    return this->valid_;
+}
+
+bool retron::headless_host::advance()
+{
+    if (!this->valid_)
+    {
+        return false;
+    }
+
+    const retron::replay::frame_t* replay_frame = this->replay ? this->replay->frame(this->frame_count_) : nullptr;
+    if (this->replay && !replay_frame)
+    {
+        return false;
+    }
+
+    if (replay_frame)
+    {
+        const retron::replay::input_t& input = replay_frame->inputs[0];
+        this->input_device.press(ff::point_int(input.move_x, input.move_y), ff::point_int(input.shot_x, input.shot_y));
+    }
+    else
+    {
+        this->input_device.advance(this->frame_count_);
+    }
+
+    this->input_events_->advance();
+
+    for (auto& i : this->player_palettes)
+    {
+        i->advance();
+    }
+
+    // Same vectors that level_logic::advance_player will read from the input events this frame
+    retron::replay::frame_t frame{};
+    frame.inputs[0] = retron::replay::make_input(
+        retron::helpers::get_press_vector(*this->input_events_, false),
+        retron::helpers::get_press_vector(*this->input_events_, true));
+
+    this->level_->advance_time();
+    this->frame_count_++;
+
+    frame.hash = retron::replay::hash_state(this->level_->host_registry(), this->level_->host_frame_count());
+    this->recording_.add_frame(frame);
+
+    if (replay_frame && replay_frame->hash != frame.hash)
+    {
+        this->diverged_frame_ = this->frame_count_ - 1;
+        return false;
+    }
+
+    // Same transitions as retron::game_state, for a single player
+    switch (this->level_->phase())
+    {
+        case retron::level_phase::ready:
+            this->level_->start();
+            break;
+
+        case retron::level_phase::dead:
+            if (this->player_.lives > 0)
+            {
+                this->player_.lives--;
+                this->level_->restart();
+            }
+            else
+            {
+                this->player_.game_over = true;
+                this->level_->stop();
+            }
+            break;
+
+        case retron::level_phase::won:
+        case retron::level_phase::game_over:
+            return false;
+    }
+
+    return true;
+}
+
+size_t retron::headless_host::frame_count() const
+{
+    return this->frame_count_;
+}
+
+retron::level& retron::headless_host::level() const
+{
+    assert(this->level_);
+    return *this->level_;
+}
+
+const retron::player& retron::headless_host::player() const
+{
+    return this->player_;
+}
+
+const retron::replay& retron::headless_host::recording() const
+{
+    return this->recording_;
+}
+
+std::optional<size_t> retron::headless_host::diverged_frame() const
+{
+    return this->diverged_frame_;
+}
+
+retron::audio& retron::headless_host::audio()
+{
+    ::not_available();
+}
+
+const retron::system_options& retron::headless_host::system_options() const
+{
+    return this->system_options_;
+}
+
+const retron::game_options& retron::headless_host::default_game_options() const
+{
+    return this->game_options_;
+}
+
+const retron::game_spec& retron::headless_host::game_spec() const
+{
+    return this->game_spec_;
+}
+
+void retron::headless_host::system_options(const retron::system_options& options)
+{
+    this->system_options_ = options;
+}
+
+void retron::headless_host::default_game_options(const retron::game_options& options)
+{
+    this->game_options_ = options;
+}
+
+ff::palette_base& retron::headless_host::palette()
+{
+    // Same as the game, the main palette is player 0's cycle of palette_main
+    return this->player_palette(0);
+}
+
+ff::palette_base& retron::headless_host::player_palette(size_t player)
+{
+    return *this->player_palettes[player];
+}
+
+ff::draw_device& retron::headless_host::draw_device() const
+{
+    ::not_available();
+}
+
+retron::render_targets* retron::headless_host::render_targets() const
+{
+    return nullptr;
+}
+
+void retron::headless_host::push_render_targets(retron::render_targets& targets)
+{
+    ::not_available();
+}
+
+void retron::headless_host::pop_render_targets(ff::dx11_target_base& final_target)
+{
+    ::not_available();
+}
+
+ff::fixed_int retron::headless_host::render_interpolation() const
+{
+    // Renders always line up with a tick
+    return 1_f;
+}
+
+ff::signal_sink<>& retron::headless_host::reload_resources_sink()
+{
+    return this->reload_resources_signal;
+}
+
+bool retron::headless_host::rebuilding_resources() const
+{
+    return false;
+}
+
+retron::render_debug_t retron::headless_host::render_debug() const
+{
+    return retron::render_debug_t::none;
+}
+
+void retron::headless_host::render_debug(retron::render_debug_t flags)
+{}
+
+retron::debug_cheats_t retron::headless_host::debug_cheats() const
+{
+    return this->debug_cheats_;
+}
+
+void retron::headless_host::debug_cheats(retron::debug_cheats_t flags)
+{
+    this->debug_cheats_ = flags;
+}
+
+void retron::headless_host::debug_command(size_t command_id)
+{}
+
+const retron::game_options& retron::headless_host::game_options() const
+{
+    return this->game_options_;
+}
+
+const retron::difficulty_spec& retron::headless_host::difficulty_spec() const
+{
+    return this->difficulty_spec_;
+}
+
+const ff::input_event_provider& retron::headless_host::input_events(const retron::player& player) const
+{
+    return *this->input_events_;
+}
+
+void retron::headless_host::player_add_points(const retron::player& player, size_t points)
+{
+    this->player_.points += points;
+
+    if (this->player_.next_life_points && this->player_.points >= this->player_.next_life_points)
+    {
+        const size_t next = this->difficulty_spec_.next_free_life;
+        size_t lives = 1;
+
+        if (next)
+        {
+            lives += (this->player_.points - this->player_.next_life_points) / next;
+            this->player_.next_life_points += lives * next;
+        }
+        else
+        {
+            this->player_.next_life_points = 0;
+        }
+
+        this->player_.lives += lives;
+    }
+}
+
+bool retron::headless_host::coop_take_life(const retron::player& player)
+{
+    return false;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "source/core/app_service.h"
+#include "source/core/game_service.h"
+#include "source/core/game_spec.h"
+#include "source/core/options.h"
+#include "source/headless/headless_input.h"
+#include "source/level/replay.h"
+
+namespace retron
+{
+    class level;
+
+    struct headless_params
+    {
+        std::string difficulty_id;
+        std::string level_id; // empty for the first level of the difficulty
+        std::shared_ptr<const retron::level_spec> level_spec; // used instead of level_id, for generated levels
+        std::string input_path; // empty for no input
+        std::shared_ptr<const retron::replay> replay; // input comes from here instead, and every frame is checked against it
+        uint32_t seed;
+    };
+
+    // Runs a single player level without a window, UI or audio. Rendering only works with a CPU draw target.
+    class headless_host : public retron::app_service, public retron::game_service
+    {
+    public:
+        headless_host(const retron::headless_params& params);
+        virtual ~headless_host() override;
+
+        bool valid() const;
+        bool advance(); // returns false once the level is won or over
+        size_t frame_count() const;
+        retron::level& level() const;
+        const retron::player& player() const;
+        const retron::replay& recording() const;
+        std::optional<size_t> diverged_frame() const;
+
+        // retron::app_service
+        virtual retron::audio& audio() override;
+        virtual const retron::system_options& system_options() const override;
+        virtual const retron::game_options& default_game_options() const override;
+        virtual const retron::game_spec& game_spec() const override;
+        virtual void system_options(const retron::system_options& options) override;
+        virtual void default_game_options(const retron::game_options& options) override;
+        virtual ff::palette_base& palette() override;
+        virtual ff::palette_base& player_palette(size_t player) override;
+        virtual ff::draw_device& draw_device() const override;
+        virtual retron::render_targets* render_targets() const override;
+        virtual void push_render_targets(retron::render_targets& targets) override;
+        virtual void pop_render_targets(ff::dx11_target_base& final_target) override;
+        virtual ff::fixed_int render_interpolation() const override;
+        virtual ff::signal_sink<>& reload_resources_sink() override;
+        virtual bool rebuilding_resources() const override;
+        virtual retron::render_debug_t render_debug() const override;
+        virtual void render_debug(retron::render_debug_t flags) override;
+        virtual retron::debug_cheats_t debug_cheats() const override;
+        virtual void debug_cheats(retron::debug_cheats_t flags) override;
+        virtual void debug_command(size_t command_id) override;
+
+        // retron::game_service
+        virtual const retron::game_options& game_options() const override;
+        virtual const retron::difficulty_spec& difficulty_spec() const override;
+        virtual const ff::input_event_provider& input_events(const retron::player& player) const override;
+        virtual void player_add_points(const retron::player& player, size_t points) override;
+        virtual bool coop_take_life(const retron::player& player) override;
+
+    private:
+        retron::system_options system_options_;
+        retron::game_options game_options_;
+        retron::game_spec game_spec_;
+        retron::difficulty_spec difficulty_spec_;
+        retron::player player_;
+
+        ff::auto_resource<ff::palette_data> palette_data;
+        std::array<std::shared_ptr<ff::palette_cycle>, constants::MAX_PLAYERS> player_palettes;
+
+        retron::headless_input input_device;
+        ff::auto_resource<ff::input_mapping> input_mapping;
+        std::unique_ptr<ff::input_event_provider> input_events_;
+
+        std::shared_ptr<const retron::replay> replay;
+        retron::replay recording_;
+        std::optional<size_t> diverged_frame_;
+
+        std::shared_ptr<retron::level> level_;
+        ff::signal<> reload_resources_signal;
+        retron::debug_cheats_t debug_cheats_;
+        size_t frame_count_;
+        bool valid_;
+    };
+}
@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "source/headless/headless_input.h"
+
+// Virtual key codes, which is what input mappings store, without needing the Windows headers
+static const int KEY_LEFT = 0x25;
+static const int KEY_UP = 0x26;
+static const int KEY_RIGHT = 0x27;
+static const int KEY_DOWN = 0x28;
+
+// Same keys as the keyboard part of "player_controls"
+static const std::array<std::pair<std::string_view, int>, 8> ACTION_KEYS
+{
+    std::make_pair("up"sv, 'W'),
+    std::make_pair("down"sv, 'S'),
+    std::make_pair("left"sv, 'A'),
+    std::make_pair("right"sv, 'D'),
+    std::make_pair("shoot_up"sv, ::KEY_UP),
+    std::make_pair("shoot_down"sv, ::KEY_DOWN),
+    std::make_pair("shoot_left"sv, ::KEY_LEFT),
+    std::make_pair("shoot_right"sv, ::KEY_RIGHT),
+};
+
+retron::headless_input::headless_input()
+    : next_entry(0)
+    , valid_(true)
+{}
+
+retron::headless_input::headless_input(std::istream& script)
+    : headless_input()
+{
+    std::string line;
+    while (this->valid_ && std::getline(script, line))
+    {
+        std::istringstream line_stream(line);
+        entry_t entry{};
+
+        if (line.empty() || line[0] == '#' || !(line_stream >> entry.frame))
+        {
+            continue;
+        }
+
+        for (std::string action; line_stream >> action; )
+        {
+            auto i = std::find_if(::ACTION_KEYS.cbegin(), ::ACTION_KEYS.cend(), [&action](const auto& pair)
+                {
+                    return pair.first == action;
+                });
+
+            if (i != ::ACTION_KEYS.cend())
+            {
+                entry.keys.push_back(i->second);
+            }
+            else
+            {
+                this->valid_ = false;
+            }
+        }
+
+        this->valid_ = this->valid_ && (this->entries.empty() || this->entries.back().frame < entry.frame);
+        this->entries.push_back(std::move(entry));
+    }
+}
+
+void retron::headless_input::advance(size_t frame)
+{
+    this->pressed_keys.clear();
+
+    while (this->next_entry < this->entries.size() && this->entries[this->next_entry].frame <= frame)
+    {
+        this->keys_changed(this->entries[this->next_entry++].keys);
+    }
+}
+
+void retron::headless_input::press(const ff::point_int& move, const ff::point_int& shot)
+{
+    std::vector<int> new_keys;
+    new_keys.reserve(4);
+
+    if (move.x)
+    {
+        new_keys.push_back(::ACTION_KEYS[move.x < 0 ? 2 : 3].second);
+    }
+
+    if (move.y)
+    {
+        new_keys.push_back(::ACTION_KEYS[move.y < 0 ? 0 : 1].second);
+    }
+
+    if (shot.x)
+    {
+        new_keys.push_back(::ACTION_KEYS[shot.x < 0 ? 6 : 7].second);
+    }
+
+    if (shot.y)
+    {
+        new_keys.push_back(::ACTION_KEYS[shot.y < 0 ? 4 : 5].second);
+    }
+
+    this->pressed_keys.clear();
+    this->keys_changed(new_keys);
+}
+
+bool retron::headless_input::valid() const
+{
+    return this->valid_;
+}
+
+bool retron::headless_input::pressing(int vk) const
+{
+    return std::find(this->keys.cbegin(), this->keys.cend(), vk) != this->keys.cend();
+}
+
+int retron::headless_input::press_count(int vk) const
+{
+    return static_cast<int>(std::count(this->pressed_keys.cbegin(), this->pressed_keys.cend(), vk));
+}
+
+float retron::headless_input::analog_value(int vk) const
+{
+    return this->pressing(vk) ? 1.0f : 0.0f;
+}
+
+void retron::headless_input::keys_changed(const std::vector<int>& new_keys)
+{
+    for (int vk : new_keys)
+    {
+        if (std::find(this->keys.cbegin(), this->keys.cend(), vk) == this->keys.cend())
+        {
+            this->pressed_keys.push_back(vk);
+        }
+    }
+
+    this->keys = new_keys;
+}
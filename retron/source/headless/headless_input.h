@@ -0,0 +1,37 @@
+#pragma once
+
+namespace retron
+{
+    // Keyboard stand-in that presses the player control keys from a script, one line per change:
+    // <frame> [up|down|left|right|shoot_up|shoot_down|shoot_left|shoot_right]...
+    class headless_input : public ff::input_vk
+    {
+    public:
+        headless_input();
+        headless_input(std::istream& script);
+
+        void advance(size_t frame);
+        void press(const ff::point_int& move, const ff::point_int& shot); // instead of advance(), for replays
+        bool valid() const;
+
+        // ff::input_vk
+        virtual bool pressing(int vk) const override;
+        virtual int press_count(int vk) const override;
+        virtual float analog_value(int vk) const override;
+
+    private:
+        void keys_changed(const std::vector<int>& new_keys);
+
+        struct entry_t
+        {
+            size_t frame;
+            std::vector<int> keys;
+        };
+
+        std::vector<entry_t> entries;
+        std::vector<int> keys;
+        std::vector<int> pressed_keys;
+        size_t next_entry;
+        bool valid_;
+    };
+}
@@ -0,0 +1,244 @@
+#include "pch.h"
+#include "source/core/profiler.h"
+#include "source/headless/benchmark.h"
+#include "source/headless/cpu_draw.h"
+#include "source/headless/draw_test.h"
+#include "source/headless/headless_host.h"
+#include "source/headless/headless_main.h"
+#include "source/level/level.h"
+#include "source/level/replay.h"
+
+static const size_t DEFAULT_FRAMES = 60 * 60;
+
+static std::string_view arg_value(const std::vector<std::string>& args, std::string_view name)
+{
+    for (size_t i = 0; i + 1 < args.size(); i++)
+    {
+        if (args[i] == name)
+        {
+            return args[i + 1];
+        }
+    }
+
+    return {};
+}
+
+static size_t arg_size(const std::vector<std::string>& args, std::string_view name, size_t default_value)
+{
+    std::string_view value = ::arg_value(args, name);
+    return value.size() ? static_cast<size_t>(std::strtoull(std::string(value).c_str(), nullptr, 10)) : default_value;
+}
+
+// Writes and checks the last rendered frame, returns the exit code
+static int finish_image(const retron::cpu_draw& draw, std::string_view image_path, std::string_view compare_path, std::ostream& output, std::ostream& errors)
+{
+    if (image_path.size())
+    {
+        std::ofstream image_stream(std::string(image_path), std::ios::binary);
+        if (!draw.write_pgm(image_stream))
+        {
+            errors << "Failed to write image: " << image_path << "\n";
+            return 1;
+        }
+    }
+
+    if (compare_path.size())
+    {
+        std::ifstream compare_stream(std::string(compare_path), std::ios::binary);
+        std::optional<size_t> diff_count = draw.compare_pgm(compare_stream);
+        if (!diff_count)
+        {
+            errors << "Invalid golden image: " << compare_path << "\n";
+            return 1;
+        }
+
+        if (*diff_count)
+        {
+            output << "image: " << *diff_count << " pixels differ from " << compare_path << "\n";
+            return 3;
+        }
+
+        output << "image: matched " << compare_path << "\n";
+    }
+
+    return 0;
+}
+
+bool retron::headless_requested(const std::vector<std::string>& args)
+{
+    return std::find(args.cbegin(), args.cend(), "-headless"sv) != args.cend();
+}
+
+int retron::headless_main(const std::vector<std::string>& args, std::ostream& output, std::ostream& errors)
+{
+    size_t frames = ::arg_size(args, "-frames", ::DEFAULT_FRAMES);
+
+    retron::headless_params params{};
+    params.difficulty_id = ::arg_value(args, "-difficulty");
+    params.level_id = ::arg_value(args, "-level");
+    params.input_path = ::arg_value(args, "-input");
+
+    std::string_view seed_arg = ::arg_value(args, "-seed");
+    params.seed = seed_arg.size()
+        ? static_cast<uint32_t>(std::strtoul(std::string(seed_arg).c_str(), nullptr, 10))
+        : static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    std::string_view replay_path = ::arg_value(args, "-replay");
+    if (replay_path.size())
+    {
+        auto replay = std::make_shared<retron::replay>();
+        std::ifstream replay_stream(std::string(replay_path), std::ios::binary);
+        if (!replay->load(replay_stream))
+        {
+            errors << "Invalid replay: " << replay_path << "\n";
+            return 1;
+        }
+
+        params.difficulty_id = replay->difficulty_id();
+        params.level_id = replay->level_id();
+        params.input_path.clear();
+        params.seed = replay->seed();
+        params.replay = replay;
+        frames = replay->frame_count();
+    }
+
+    if (std::find(args.cbegin(), args.cend(), "-benchmark"sv) != args.cend())
+    {
+        return retron::run_stress_benchmark(frames, output);
+    }
+
+    if (std::find(args.cbegin(), args.cend(), "-render_benchmark"sv) != args.cend())
+    {
+        return retron::run_render_benchmark(frames, output);
+    }
+
+    const size_t render_bands = ::arg_size(args, "-bands", 1);
+    std::string_view image_path = ::arg_value(args, "-image");
+    std::string_view compare_path = ::arg_value(args, "-compare_image");
+
+    if (std::find(args.cbegin(), args.cend(), "-draw_test"sv) != args.cend())
+    {
+        retron::cpu_draw draw(retron::constants::RENDER_SIZE.cast<int>());
+        draw.begin();
+        retron::draw_test_scene(draw);
+        draw.end(render_bands);
+        return ::finish_image(draw, image_path, compare_path, output, errors);
+    }
+
+    retron::headless_host host(params);
+    if (!host.valid())
+    {
+        errors << "Invalid difficulty, level or input script\n";
+        return 1;
+    }
+
+    std::string_view trace_path = ::arg_value(args, "-trace");
+    retron::profiler::enabled(trace_path.size() > 0);
+
+    // Rendering is optional and timed separately, so it doesn't change the simulation numbers
+    const size_t render_every = ::arg_size(args, "-render_every", 0);
+    std::unique_ptr<retron::cpu_draw> draw;
+    std::chrono::duration<double, std::milli> render_elapsed{};
+    size_t render_count = 0;
+
+    if (render_every || image_path.size() || compare_path.size())
+    {
+        draw = std::make_unique<retron::cpu_draw>(retron::constants::RENDER_SIZE.cast<int>());
+    }
+
+    auto render_frame = [&draw, &host, &render_elapsed, &render_count, render_bands]()
+        {
+            auto render_start = std::chrono::steady_clock::now();
+            draw->begin();
+            host.level().render(*draw);
+            draw->end(render_bands);
+            render_elapsed += std::chrono::steady_clock::now() - render_start;
+            render_count++;
+        };
+
+    size_t visited_total = 0;
+    size_t visited_peak = 0;
+
+    auto start_time = std::chrono::steady_clock::now();
+    while (host.frame_count() < frames && host.advance())
+    {
+        visited_total += host.level().visited_entity_count();
+        visited_peak = std::max(visited_peak, host.level().visited_entity_count());
+
+        if (render_every && host.frame_count() % render_every == 0)
+        {
+            render_frame();
+        }
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_time - render_elapsed;
+
+    if (image_path.size() || compare_path.size())
+    {
+        render_frame();
+    }
+
+    output
+        << "frames: " << host.frame_count() << "\n"
+        << "phase: " << static_cast<int>(host.level().phase()) << "\n"
+        << "points: " << host.player().points << "\n"
+        << "lives: " << host.player().lives << "\n"
+        << "total_ms: " << elapsed.count() << "\n"
+        << "frame_ms: " << (host.frame_count() ? elapsed.count() / host.frame_count() : 0.0) << "\n"
+        << "simulated_fps: " << (elapsed.count() > 0.0 ? host.frame_count() * 1000.0 / elapsed.count() : 0.0) << "\n"
+        << "visited_per_frame: " << (host.frame_count() ? static_cast<double>(visited_total) / host.frame_count() : 0.0) << "\n"
+        << "visited_peak: " << visited_peak << "\n"
+        << "particles_peak: " << host.level().particle_stats().peak_count << "\n"
+        << "particles_thinned: " << host.level().particle_stats().thinned_spawns << "\n"
+        << "particles_dropped: " << host.level().particle_stats().dropped_particles << "\n"
+        << "seed: " << host.recording().seed() << "\n";
+
+    if (render_count)
+    {
+        output
+            << "rendered_frames: " << render_count << "\n"
+            << "render_ms: " << render_elapsed.count() / render_count << "\n";
+    }
+
+    if (trace_path.size())
+    {
+        retron::profiler::enabled(false);
+        std::ofstream trace_stream{ std::string(trace_path) };
+        if (!retron::profiler::write_chrome_trace(trace_stream))
+        {
+            errors << "Failed to write trace: " << trace_path << "\n";
+            return 1;
+        }
+    }
+
+    std::string_view record_path = ::arg_value(args, "-record");
+    if (record_path.size())
+    {
+        std::ofstream record_stream(std::string(record_path), std::ios::binary);
+        if (!host.recording().save(record_stream))
+        {
+            errors << "Failed to write replay: " << record_path << "\n";
+            return 1;
+        }
+    }
+
+    if (params.replay)
+    {
+        // Ending early means the level was won or lost on a different frame
+        std::optional<size_t> diverged_frame = host.diverged_frame();
+        if (!diverged_frame && host.frame_count() < params.replay->frame_count())
+        {
+            diverged_frame = host.frame_count();
+        }
+
+        if (diverged_frame)
+        {
+            output << "replay: diverged at frame " << *diverged_frame << "\n";
+            return 2;
+        }
+
+        output << "replay: matched " << host.frame_count() << " frames\n";
+    }
+
+    return (image_path.size() || compare_path.size()) ? ::finish_image(*draw, image_path, compare_path, output, errors) : 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace retron
+{
+    // Runs levels without a window when started with: -headless [-difficulty <id>] [-level <id>] [-input <script>] [-frames <count>]
+    // [-seed <n>] [-record <replay>] [-replay <replay>] [-trace <json>]
+    // [-render_every <n>] [-bands <n>] [-image <pgm>] [-compare_image <golden pgm>]
+    // -benchmark runs generated stress levels instead, for -frames each
+    // -draw_test renders retron::draw_test_scene instead of a level, check it with -compare_image retron/golden/draw_test.pgm.
+    // A golden image that doesn't match exits with 3.
+    //
+    // Only uses the standard library, ff and the game. The caller owns the platform parts: getting the arguments, attaching
+    // a console, creating the graphics device that resources load textures with, and registering the resources.
+    bool headless_requested(const std::vector<std::string>& args);
+    int headless_main(const std::vector<std::string>& args, std::ostream& output, std::ostream& errors);
+}
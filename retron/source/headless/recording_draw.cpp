@@ -0,0 +1,265 @@
+#include "pch.h"
+#include "source/headless/recording_draw.h"
+
+retron::recording_draw::recording_draw()
+    : stats_{}
+    , last_texture(nullptr)
+    , last_remap_hash(0)
+    , drawn(false)
+{
+    this->commands_.reserve(4096);
+}
+
+void retron::recording_draw::begin()
+{
+    this->commands_.clear();
+    this->remap_hashes.clear();
+    this->stats_ = {};
+    this->last_texture = nullptr;
+    this->last_remap_hash = 0;
+    this->drawn = false;
+}
+
+const std::vector<retron::recording_draw::command_t>& retron::recording_draw::commands() const
+{
+    return this->commands_;
+}
+
+const retron::recording_draw::stats_t& retron::recording_draw::stats() const
+{
+    return this->stats_;
+}
+
+void retron::recording_draw::draw_sprite(const ff::sprite_data& sprite, const ff::transform& transform)
+{
+    this->add_draw(command_type::sprite, sprite.view());
+}
+
+void retron::recording_draw::draw_line_strip(const ff::point_float* points, const DirectX::XMFLOAT4* colors, size_t count, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_line_strip(const ff::point_float* points, size_t count, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_line(const ff::point_float& start, const ff::point_float& end, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_filled_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4* colors)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_filled_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4& color)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_filled_triangles(const ff::point_float* points, const DirectX::XMFLOAT4* colors, size_t count)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_filled_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& color)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_filled_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& inside_color, const DirectX::XMFLOAT4& outside_color)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_outline_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_outline_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_outline_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& inside_color, const DirectX::XMFLOAT4& outside_color, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_line_strip(const ff::point_float* points, const int* colors, size_t count, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_line_strip(const ff::point_float* points, size_t count, int color, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_line(const ff::point_float& start, const ff::point_float& end, int color, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_filled_rectangle(const ff::rect_float& rect, const int* colors)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_filled_rectangle(const ff::rect_float& rect, int color)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_filled_triangles(const ff::point_float* points, const int* colors, size_t count)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_filled_circle(const ff::point_float& center, float radius, int color)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_filled_circle(const ff::point_float& center, float radius, int inside_color, int outside_color)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_outline_rectangle(const ff::rect_float& rect, int color, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_outline_circle(const ff::point_float& center, float radius, int color, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+void retron::recording_draw::draw_palette_outline_circle(const ff::point_float& center, float radius, int inside_color, int outside_color, float thickness, bool pixel_thickness)
+{
+    this->add_draw(command_type::geometry, nullptr);
+}
+
+ff::matrix_stack& retron::recording_draw::world_matrix_stack()
+{
+    return this->world_matrix_stack_;
+}
+
+void retron::recording_draw::nudge_depth()
+{}
+
+void retron::recording_draw::push_palette(ff::palette_base* palette)
+{
+    this->add_state(command_type::push_palette, palette);
+}
+
+void retron::recording_draw::pop_palette()
+{
+    this->add_state(command_type::pop_palette);
+}
+
+void retron::recording_draw::push_palette_remap(const uint8_t* remap, size_t hash)
+{
+    this->remap_hashes.push_back(hash);
+    this->stats_.remap_pushes++;
+    this->commands_.push_back(command_t{ command_type::push_remap, remap });
+}
+
+void retron::recording_draw::pop_palette_remap()
+{
+    assert(this->remap_hashes.size());
+    this->remap_hashes.pop_back();
+    this->commands_.push_back(command_t{ command_type::pop_remap, nullptr });
+}
+
+void retron::recording_draw::push_no_overlap()
+{
+    this->add_state(command_type::push_state);
+}
+
+void retron::recording_draw::pop_no_overlap()
+{
+    this->add_state(command_type::pop_state);
+}
+
+void retron::recording_draw::push_opaque()
+{
+    this->add_state(command_type::push_state);
+}
+
+void retron::recording_draw::pop_opaque()
+{
+    this->add_state(command_type::pop_state);
+}
+
+void retron::recording_draw::push_pre_multiplied_alpha()
+{
+    this->add_state(command_type::push_state);
+}
+
+void retron::recording_draw::pop_pre_multiplied_alpha()
+{
+    this->add_state(command_type::pop_state);
+}
+
+void retron::recording_draw::push_custom_context(ff::draw_base::custom_context_func&& func)
+{
+    this->add_state(command_type::push_state);
+}
+
+void retron::recording_draw::pop_custom_context()
+{
+    this->add_state(command_type::pop_state);
+}
+
+void retron::recording_draw::push_texture_sampler(D3D11_FILTER filter)
+{
+    this->add_state(command_type::push_state);
+}
+
+void retron::recording_draw::pop_texture_sampler()
+{
+    this->add_state(command_type::pop_state);
+}
+
+void retron::recording_draw::add_draw(command_type type, const void* texture)
+{
+    // Pushing the same remap again, or popping back to it, doesn't break a batch
+    const size_t remap_hash = this->remap_hashes.size() ? this->remap_hashes.back() : 0;
+
+    if (this->drawn)
+    {
+        if (texture != this->last_texture)
+        {
+            this->stats_.texture_switches++;
+            this->stats_.state_changes++;
+        }
+
+        if (remap_hash != this->last_remap_hash)
+        {
+            this->stats_.remap_switches++;
+            this->stats_.state_changes++;
+        }
+    }
+
+    this->last_texture = texture;
+    this->last_remap_hash = remap_hash;
+    this->drawn = true;
+
+    this->stats_.draws++;
+    this->stats_.sprites += (type == command_type::sprite);
+    this->commands_.push_back(command_t{ type, texture });
+}
+
+void retron::recording_draw::add_state(command_type type, const void* key)
+{
+    // Any other state forces a flush, so the next draw starts a new batch either way
+    this->stats_.state_changes++;
+    this->drawn = false;
+    this->commands_.push_back(command_t{ type, key });
+}
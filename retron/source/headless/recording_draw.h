@@ -0,0 +1,106 @@
+#pragma once
+
+namespace retron
+{
+    // Records what gets submitted to a draw target without drawing anything, to measure how well draws could batch.
+    // A state change is counted when a draw needs a different texture or palette remap than the draw before it.
+    class recording_draw : public ff::draw_base
+    {
+    public:
+        enum class command_type : uint8_t
+        {
+            sprite,
+            geometry,
+            push_remap,
+            pop_remap,
+            push_palette,
+            pop_palette,
+            push_state, // no overlap, opaque, alpha, custom context or sampler
+            pop_state,
+        };
+
+        struct command_t
+        {
+            command_type type;
+            const void* key; // texture view for sprites, remap for pushes
+        };
+
+        struct stats_t
+        {
+            size_t draws;
+            size_t sprites;
+            size_t remap_pushes;
+            size_t texture_switches;
+            size_t remap_switches;
+            size_t state_changes; // texture and remap switches, plus every other push or pop
+        };
+
+        recording_draw();
+        recording_draw(const recording_draw& other) = delete;
+
+        recording_draw& operator=(const recording_draw& other) = delete;
+
+        void begin();
+        const std::vector<command_t>& commands() const;
+        const stats_t& stats() const;
+
+        // ff::draw_base
+        virtual void draw_sprite(const ff::sprite_data& sprite, const ff::transform& transform) override;
+
+        virtual void draw_line_strip(const ff::point_float* points, const DirectX::XMFLOAT4* colors, size_t count, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_line_strip(const ff::point_float* points, size_t count, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_line(const ff::point_float& start, const ff::point_float& end, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_filled_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4* colors) override;
+        virtual void draw_filled_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4& color) override;
+        virtual void draw_filled_triangles(const ff::point_float* points, const DirectX::XMFLOAT4* colors, size_t count) override;
+        virtual void draw_filled_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& color) override;
+        virtual void draw_filled_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& inside_color, const DirectX::XMFLOAT4& outside_color) override;
+        virtual void draw_outline_rectangle(const ff::rect_float& rect, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_outline_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_outline_circle(const ff::point_float& center, float radius, const DirectX::XMFLOAT4& inside_color, const DirectX::XMFLOAT4& outside_color, float thickness, bool pixel_thickness = false) override;
+
+        virtual void draw_palette_line_strip(const ff::point_float* points, const int* colors, size_t count, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_palette_line_strip(const ff::point_float* points, size_t count, int color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_palette_line(const ff::point_float& start, const ff::point_float& end, int color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_palette_filled_rectangle(const ff::rect_float& rect, const int* colors) override;
+        virtual void draw_palette_filled_rectangle(const ff::rect_float& rect, int color) override;
+        virtual void draw_palette_filled_triangles(const ff::point_float* points, const int* colors, size_t count) override;
+        virtual void draw_palette_filled_circle(const ff::point_float& center, float radius, int color) override;
+        virtual void draw_palette_filled_circle(const ff::point_float& center, float radius, int inside_color, int outside_color) override;
+        virtual void draw_palette_outline_rectangle(const ff::rect_float& rect, int color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_palette_outline_circle(const ff::point_float& center, float radius, int color, float thickness, bool pixel_thickness = false) override;
+        virtual void draw_palette_outline_circle(const ff::point_float& center, float radius, int inside_color, int outside_color, float thickness, bool pixel_thickness = false) override;
+
+        virtual ff::matrix_stack& world_matrix_stack() override;
+        virtual void nudge_depth() override;
+
+        virtual void push_palette(ff::palette_base* palette) override;
+        virtual void pop_palette() override;
+        virtual void push_palette_remap(const uint8_t* remap, size_t hash) override;
+        virtual void pop_palette_remap() override;
+        virtual void push_no_overlap() override;
+        virtual void pop_no_overlap() override;
+        virtual void push_opaque() override;
+        virtual void pop_opaque() override;
+        virtual void push_pre_multiplied_alpha() override;
+        virtual void pop_pre_multiplied_alpha() override;
+        virtual void push_custom_context(ff::draw_base::custom_context_func&& func) override;
+        virtual void pop_custom_context() override;
+        virtual void push_texture_sampler(D3D11_FILTER filter) override;
+        virtual void pop_texture_sampler() override;
+
+    private:
+        void add_draw(command_type type, const void* texture);
+        void add_state(command_type type, const void* key = nullptr);
+
+        std::vector<command_t> commands_;
+        std::vector<size_t> remap_hashes;
+        ff::matrix_stack world_matrix_stack_;
+        stats_t stats_;
+
+        // What the last draw used
+        const void* last_texture;
+        size_t last_remap_hash;
+        bool drawn;
+    };
+}
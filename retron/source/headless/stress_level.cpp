@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "source/headless/stress_level.h"
+
+// Same layout as the shipped levels
+static const ff::point_int BOUNDS_TOP_LEFT(8, 12);
+static const ff::point_int SAFE_SIZE(96, 64);
+static const int WALL_LENGTH = 40;
+static const int WALL_THICKNESS = 8;
+static const size_t ELECTRODE_TYPE_COUNT = 4;
+static const size_t BONUS_TYPE_COUNT = 5;
+
+static size_t share(size_t total, size_t index, size_t count)
+{
+    return total / count + (index < total % count ? 1 : 0);
+}
+
+static ff::rect_fixed to_rect_fixed(int left, int top, int right, int bottom)
+{
+    return ff::rect_fixed(ff::fixed_int(left), ff::fixed_int(top), ff::fixed_int(right), ff::fixed_int(bottom));
+}
+
+static void add_walls(retron::level_spec& spec, const retron::stress_level_params& params, const ff::rect_int& bounds, const ff::rect_int& safe, std::mt19937& random)
+{
+    // Walls start at the corners of a lattice, so they line up like a maze
+    const int cell_size = std::max(::WALL_LENGTH + ::WALL_THICKNESS, static_cast<int>(std::sqrt(static_cast<double>(bounds.area()) / params.boxes)));
+    const int cols = std::max(1, bounds.width() / cell_size);
+    const int rows = std::max(1, bounds.height() / cell_size);
+
+    std::vector<int> cells(static_cast<size_t>(cols * rows));
+    std::iota(cells.begin(), cells.end(), 0);
+    std::shuffle(cells.begin(), cells.end(), random);
+
+    const ff::rect_int keep_clear(safe.left - ::WALL_THICKNESS, safe.top - ::WALL_THICKNESS, safe.right + ::WALL_THICKNESS, safe.bottom + ::WALL_THICKNESS);
+    size_t count = 0;
+
+    for (int cell : cells)
+    {
+        if (count == params.boxes)
+        {
+            break;
+        }
+
+        const int left = bounds.left + (cell % cols) * cell_size + ::WALL_THICKNESS;
+        const int top = bounds.top + (cell / cols) * cell_size + ::WALL_THICKNESS;
+        const bool vertical = (random() & 1) != 0;
+        const int right = std::min(bounds.right - ::WALL_THICKNESS, left + (vertical ? ::WALL_THICKNESS : ::WALL_LENGTH));
+        const int bottom = std::min(bounds.bottom - ::WALL_THICKNESS, top + (vertical ? ::WALL_LENGTH : ::WALL_THICKNESS));
+
+        if (right > left && bottom > top &&
+            (right <= keep_clear.left || left >= keep_clear.right || bottom <= keep_clear.top || top >= keep_clear.bottom))
+        {
+            spec.rects.push_back(retron::level_rect{ retron::level_rect::type::box, ::to_rect_fixed(left, top, right, bottom) });
+            count++;
+        }
+    }
+}
+
+static void add_objects(retron::level_spec& spec, const retron::stress_level_params& params, const ff::rect_int& bounds)
+{
+    const size_t rect_count = std::max<size_t>(params.object_rects, 1);
+    const double aspect = static_cast<double>(bounds.width()) / bounds.height();
+    const int cols = std::max(1, static_cast<int>(std::ceil(std::sqrt(rect_count * aspect))));
+    const int rows = static_cast<int>((rect_count + cols - 1) / cols);
+    const int width = bounds.width() / cols;
+    const int height = bounds.height() / rows;
+
+    for (size_t i = 0; i < rect_count; i++)
+    {
+        const int left = bounds.left + static_cast<int>(i % cols) * width;
+        const int top = bounds.top + static_cast<int>(i / cols) * height;
+
+        retron::level_objects_spec objects_spec{};
+        objects_spec.type = retron::level_rect::type::objects;
+        objects_spec.rect = ::to_rect_fixed(left, top, left + width, top + height);
+        objects_spec.grunt = ::share(params.grunts, i, rect_count);
+        objects_spec.hulk = ::share(params.hulks, i, rect_count);
+        objects_spec.electrode = ::share(params.electrodes, i, rect_count);
+        objects_spec.electrode_type = i % ::ELECTRODE_TYPE_COUNT;
+        objects_spec.bonus = ::share(params.bonuses, i, rect_count);
+        objects_spec.bonus_type = static_cast<retron::bonus_type>(1 + i % ::BONUS_TYPE_COUNT);
+
+        spec.objects.push_back(objects_spec);
+    }
+}
+
+retron::level_spec retron::create_stress_level(const retron::stress_level_params& params)
+{
+    std::mt19937 random(params.seed);
+    const ff::point_int size = params.size.cast<int>();
+    const ff::rect_int bounds(::BOUNDS_TOP_LEFT, ::BOUNDS_TOP_LEFT + size);
+    const ff::point_int center = bounds.center();
+    const ff::rect_int safe(center - ::SAFE_SIZE / 2, center + ::SAFE_SIZE / 2);
+
+    retron::level_spec spec{};
+    spec.player_start = center.cast<ff::fixed_int>();
+    spec.rects.push_back(retron::level_rect{ retron::level_rect::type::bounds, ::to_rect_fixed(bounds.left, bounds.top, bounds.right, bounds.bottom) });
+    spec.rects.push_back(retron::level_rect{ retron::level_rect::type::safe, ::to_rect_fixed(safe.left, safe.top, safe.right, safe.bottom) });
+
+    if (params.boxes)
+    {
+        ::add_walls(spec, params, bounds, safe, random);
+    }
+
+    // Objects stay inside the walls that come from the bounds rect
+    ::add_objects(spec, params, ff::rect_int(bounds.left + 4, bounds.top + 4, bounds.right - 4, bounds.bottom - 4));
+
+    return spec;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "source/core/game_spec.h"
+
+namespace retron
+{
+    struct stress_level_params
+    {
+        ff::point_fixed size; // of the level bounds, can be bigger than the screen
+        size_t boxes; // maze walls
+        size_t object_rects; // objects are spread evenly over these
+        size_t grunts;
+        size_t hulks;
+        size_t electrodes;
+        size_t bonuses;
+        uint32_t seed;
+    };
+
+    // Builds a level with any number of objects for scaling benchmarks, the same seed always makes the same level
+    retron::level_spec create_stress_level(const retron::stress_level_params& params);
+}
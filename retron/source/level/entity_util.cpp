@@ -169,19 +169,19 @@ retron::entity_type retron::entity_util::bullet_for_player(retron::entity_type t
     return retron::entity_util::index(type) ? retron::entity_type::bullet_player_1 : retron::entity_type::bullet_player_0;
 }
 
-std::pair<std::string_view, std::string_view> retron::entity_util::start_particle_names_0_90(retron::entity_type type)
+std::pair<size_t, size_t> retron::entity_util::start_particle_ids_0_90(retron::entity_type type)
 {
     switch (type)
     {
         case retron::entity_type::player_0:
         case retron::entity_type::player_1:
-            return std::make_pair("player_start"sv, "player_start"sv);
+            return std::make_pair(retron::particle_effect_ids::ID_PLAYER_START, retron::particle_effect_ids::ID_PLAYER_START);
 
         case retron::entity_type::enemy_grunt:
-            return std::make_pair("grunt_start_0"sv, "grunt_start_90"sv);
+            return std::make_pair(retron::particle_effect_ids::ID_GRUNT_START_0, retron::particle_effect_ids::ID_GRUNT_START_90);
 
         case retron::entity_type::enemy_hulk:
-            return std::make_pair("hulk_start_0"sv, "hulk_start_90"sv);
+            return std::make_pair(retron::particle_effect_ids::ID_HULK_START_0, retron::particle_effect_ids::ID_HULK_START_90);
     }
 
     return {};
@@ -19,5 +19,5 @@ namespace retron::entity_util
     retron::entity_type player(size_t index);
     retron::entity_type electrode(size_t index);
     retron::entity_type bullet_for_player(retron::entity_type type);
-    std::pair<std::string_view, std::string_view> start_particle_names_0_90(retron::entity_type type);
+    std::pair<size_t, size_t> start_particle_ids_0_90(retron::entity_type type);
 }
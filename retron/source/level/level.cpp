@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "source/core/app_service.h"
 #include "source/core/game_service.h"
+#include "source/core/profiler.h"
 #include "source/core/render_targets.h"
 #include "source/level/components.h"
 #include "source/level/entity_type.h"
@@ -8,6 +9,56 @@
 #include "source/level/level.h"
 
 static const size_t MAX_DELAY_PARTICLES = 128;
+static const size_t REWIND_SNAPSHOT_COUNT = 16;
+static const size_t REWIND_SNAPSHOT_FRAMES = 60;
+static const size_t NO_FRAME = static_cast<size_t>(-1);
+
+namespace
+{
+    template<class... Ts>
+    struct component_list
+    {};
+
+    // Components that are saved as raw bytes, retron::entity_type is saved first to create the entities
+    using trivial_components = ::component_list<
+        retron::comp::position,
+        retron::comp::velocity,
+        retron::comp::direction,
+        retron::comp::scale,
+        retron::comp::rotation,
+        retron::comp::hit_box_spec,
+        retron::comp::bounds_box_spec,
+        retron::comp::rectangle,
+        retron::comp::bullet,
+        retron::comp::bonus,
+        retron::comp::grunt,
+        retron::comp::hulk,
+        retron::comp::electrode,
+        retron::comp::showing_particle_effect,
+        retron::comp::target_entity,
+        retron::comp::flag::pending_delete,
+        retron::comp::flag::clear_to_win,
+        retron::comp::flag::hulk_target,
+        retron::comp::flag::render_on_top>;
+}
+
+static ff::rect_fixed level_bounds(const retron::level_spec& level_spec)
+{
+    ff::rect_fixed bounds = retron::constants::RENDER_RECT;
+
+    for (const retron::level_rect& level_rect : level_spec.rects)
+    {
+        if (level_rect.type == retron::level_rect::type::bounds)
+        {
+            bounds.left = std::min(bounds.left, level_rect.rect.left);
+            bounds.top = std::min(bounds.top, level_rect.rect.top);
+            bounds.right = std::max(bounds.right, level_rect.rect.right);
+            bounds.bottom = std::max(bounds.bottom, level_rect.rect.bottom);
+        }
+    }
+
+    return bounds;
+}
 
 retron::level::level(retron::game_service& game_service, const retron::level_spec& level_spec, const std::vector<const retron::player*>& players)
     : game_service(game_service)
@@ -16,12 +67,18 @@ retron::level::level(retron::game_service& game_service, const retron::level_spe
     , players_(players)
     , entities(this->registry)
     , collision(this->registry)
-    , level_logic(*this, this->collision)
+    , level_logic(*this, this->collision, ::level_bounds(level_spec))
     , level_collision_logic(*this, this->entities, this->collision)
     , level_render(*this)
     , phase_(internal_phase_t::init)
     , phase_counter(0)
     , frame_count(0)
+    , previous_positions_frame(::NO_FRAME)
+    , render_interpolation_(1)
+    , interpolating(false)
+    , rewind_snapshots(::REWIND_SNAPSHOT_COUNT)
+    , rewind_next(0)
+    , rewind_count(0)
 {
     this->connections.emplace_front(this->registry.on_construct<retron::entity_type>().connect<&retron::level::handle_entity_created>(this));
     this->connections.emplace_front(this->registry.on_destroy<retron::comp::tracked_object>().connect<&retron::level::handle_tracked_entity_deleted>(this));
@@ -35,17 +92,45 @@ retron::level::level(retron::game_service& game_service, const retron::level_spe
 
 std::shared_ptr<ff::state> retron::level::advance_time()
 {
-    if (this->phase() == retron::level_phase::playing)
+    retron::profiler::scope profile_scope("level::advance_time");
+    bool playing = (this->phase() == retron::level_phase::playing);
+    if (playing)
     {
         ff::end_scope_action particle_scope = this->particles.advance_async();
-        this->advance_entities();
-        this->level_collision_logic.handle_collisions();
+        this->save_previous_positions();
+
+        {
+            retron::profiler::scope profile_scope("advance_entities");
+            this->advance_entities();
+        }
+
+        {
+            retron::profiler::scope profile_scope("handle_collisions");
+            this->level_collision_logic.handle_collisions();
+        }
+
         this->frame_count++;
     }
 
-    this->entities.flush_delete();
-    this->advance_particle_positions();
-    this->advance_phase();
+    {
+        retron::profiler::scope profile_scope("flush_delete");
+        this->entities.flush_delete();
+    }
+
+    {
+        retron::profiler::scope profile_scope("advance_particle_positions");
+        this->advance_particle_positions();
+    }
+
+    {
+        retron::profiler::scope profile_scope("advance_phase");
+        this->advance_phase();
+    }
+
+    {
+        retron::profiler::scope profile_scope("advance_rewind");
+        this->advance_rewind(playing);
+    }
 
     return nullptr;
 }
@@ -55,12 +140,18 @@ void retron::level::render()
     ff::draw_ptr draw = retron::app_service::begin_palette_draw();
     if (draw)
     {
-        this->level_render.render(*draw);
-        this->render_particles(*draw);
-        this->render_debug(*draw);
+        this->render_interpolation(retron::app_service::get().render_interpolation());
+        this->render(*draw);
     }
 }
 
+void retron::level::render(ff::draw_base& draw)
+{
+    this->level_render.render(draw);
+    this->render_particles(draw);
+    this->render_debug(draw);
+}
+
 retron::level_phase retron::level::phase() const
 {
     switch (this->phase_)
@@ -125,6 +216,243 @@ const std::vector<const retron::player*>& retron::level::players() const
     return this->players_;
 }
 
+void retron::level::render_interpolation(ff::fixed_int value)
+{
+    this->render_interpolation_ = std::clamp(value, 0_f, 1_f);
+    this->interpolating = this->interpolating || this->render_interpolation_ < 1_f;
+}
+
+template<class T, class WriteFunc>
+static void save_components(const entt::registry& registry, retron::snapshot& snapshot, const WriteFunc& write_func)
+{
+    auto view = registry.view<const T>();
+    snapshot.write(static_cast<size_t>(view.size()));
+
+    // Reverse order so that restoring recreates the same iteration order
+    for (auto i = view.rbegin(); i != view.rend(); ++i)
+    {
+        snapshot.write(*i);
+        write_func(*i);
+    }
+}
+
+template<class T>
+static void save_components(const entt::registry& registry, retron::snapshot& snapshot)
+{
+    ::save_components<T>(registry, snapshot, [&registry, &snapshot](entt::entity entity)
+        {
+            if constexpr (!std::is_empty_v<T>)
+            {
+                snapshot.write(registry.get<const T>(entity));
+            }
+        });
+}
+
+template<class... Ts>
+static void save_components(const entt::registry& registry, retron::snapshot& snapshot, ::component_list<Ts...>)
+{
+    (::save_components<Ts>(registry, snapshot), ...);
+}
+
+template<class ReadFunc>
+static void restore_components(retron::snapshot::reader& reader, const ReadFunc& read_func)
+{
+    for (size_t i = 0, count = reader.read<size_t>(); i < count; i++)
+    {
+        read_func(reader.read<entt::entity>());
+    }
+}
+
+template<class T>
+static void restore_components(entt::registry& registry, retron::snapshot::reader& reader)
+{
+    ::restore_components(reader, [&registry, &reader](entt::entity entity)
+        {
+            if constexpr (std::is_empty_v<T>)
+            {
+                registry.emplace_or_replace<T>(entity);
+            }
+            else
+            {
+                registry.emplace_or_replace<T>(entity, reader.read<T>());
+            }
+        });
+}
+
+template<class... Ts>
+static void restore_components(entt::registry& registry, retron::snapshot::reader& reader, ::component_list<Ts...>)
+{
+    (::restore_components<Ts>(registry, reader), ...);
+}
+
+template<class SpecT>
+static auto object_counts(SpecT& spec)
+{
+    return std::array{ &spec.bonus, &spec.electrode, &spec.grunt, &spec.hulk };
+}
+
+// Players keep playback state, so a snapshot needs a copy that the live entity won't advance
+static std::shared_ptr<ff::animation_player_base> copy_animation_player(const std::shared_ptr<ff::animation_player_base>& player)
+{
+    // Level entities only get players from retron::entities::create_animation
+    const ff::animation_player* animation_player = dynamic_cast<const ff::animation_player*>(player.get());
+    assert(animation_player);
+
+    return animation_player ? std::make_shared<ff::animation_player>(*animation_player) : player;
+}
+
+static size_t tracked_object_index(const std::vector<retron::level_objects_spec>& objects, const size_t& count)
+{
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        auto counts = ::object_counts(objects[i]);
+        auto h = std::find(counts.cbegin(), counts.cend(), &count);
+        if (h != counts.cend())
+        {
+            return i * counts.size() + (h - counts.cbegin());
+        }
+    }
+
+    assert(false);
+    return 0;
+}
+
+static size_t& tracked_object_count(std::vector<retron::level_objects_spec>& objects, size_t index)
+{
+    auto counts = ::object_counts(objects[index / 4]);
+    return *counts[index % counts.size()];
+}
+
+void retron::level::save_snapshot(retron::snapshot& snapshot) const
+{
+    snapshot.clear();
+    snapshot.write(this->phase_);
+    snapshot.write(this->phase_counter);
+    snapshot.write(this->frame_count);
+
+    for (const retron::level_objects_spec& object_spec : this->level_spec_.objects)
+    {
+        for (const size_t* count : ::object_counts(object_spec))
+        {
+            snapshot.write(*count);
+        }
+    }
+
+    // Entities keep their IDs, so references between them are still valid after restoring
+    ::save_components<retron::entity_type>(this->registry, snapshot);
+    ::save_components(this->registry, snapshot, ::trivial_components{});
+
+    ::save_components<retron::comp::player>(this->registry, snapshot, [this, &snapshot](entt::entity entity)
+        {
+            const retron::comp::player& comp = this->registry.get<const retron::comp::player>(entity);
+            snapshot.write(static_cast<size_t>(std::find(this->players_.cbegin(), this->players_.cend(), &comp.player.get()) - this->players_.cbegin()));
+            snapshot.write(comp.state);
+            snapshot.write(comp.state_counter);
+            snapshot.write(comp.allow_shot_frame);
+        });
+
+    ::save_components<retron::comp::animation>(this->registry, snapshot, [this, &snapshot](entt::entity entity)
+        {
+            snapshot.write_object(::copy_animation_player(this->registry.get<const retron::comp::animation>(entity).anim));
+        });
+
+    ::save_components<retron::comp::tracked_object>(this->registry, snapshot, [this, &snapshot](entt::entity entity)
+        {
+            snapshot.write(::tracked_object_index(this->level_spec_.objects, this->registry.get<const retron::comp::tracked_object>(entity).init_object_count.get()));
+        });
+
+    this->level_logic.save(snapshot);
+    this->level_collision_logic.save(snapshot);
+    snapshot.write(this->previous_positions_frame);
+    snapshot.write(this->previous_positions);
+    this->particles.save(snapshot);
+}
+
+bool retron::level::restore_snapshot(const retron::snapshot& snapshot)
+{
+    assert(!snapshot.empty());
+    if (snapshot.empty())
+    {
+        return false;
+    }
+
+    retron::snapshot::reader reader(snapshot);
+    this->entities.delete_all();
+
+    this->phase_ = reader.read<internal_phase_t>();
+    this->phase_counter = reader.read<size_t>();
+    this->frame_count = reader.read<size_t>();
+
+    for (retron::level_objects_spec& object_spec : this->level_spec_.objects)
+    {
+        for (size_t* count : ::object_counts(object_spec))
+        {
+            *count = reader.read<size_t>();
+        }
+    }
+
+    // Collision boxes, hulk targets and timers get updated through component signals
+    bool same_ids = true;
+    ::restore_components(reader, [this, &reader, &same_ids](entt::entity entity)
+        {
+            entt::entity new_entity = this->registry.create(entity);
+            same_ids = same_ids && (new_entity == entity);
+            this->registry.emplace<retron::entity_type>(new_entity, reader.read<retron::entity_type>());
+        });
+
+    if (!same_ids)
+    {
+        // Components refer to each other by ID, so they can't be attached to different entities. Start the level over instead.
+        assert(false);
+        this->phase_ = internal_phase_t::init;
+        this->internal_phase(internal_phase_t::ready);
+        return false;
+    }
+
+    ::restore_components(this->registry, reader, ::trivial_components{});
+
+    ::restore_components(reader, [this, &reader](entt::entity entity)
+        {
+            const retron::player& player = *this->players_[reader.read<size_t>()];
+            retron::comp::player::player_state state = reader.read<retron::comp::player::player_state>();
+            size_t state_counter = reader.read<size_t>();
+            size_t allow_shot_frame = reader.read<size_t>();
+
+            this->registry.emplace_or_replace<retron::comp::player>(entity, player, this->game_service.input_events(player), state, state_counter, allow_shot_frame);
+        });
+
+    ::restore_components(reader, [this, &reader](entt::entity entity)
+        {
+            // The same snapshot can be restored again, so it keeps its own copy
+            this->registry.emplace_or_replace<retron::comp::animation>(entity, ::copy_animation_player(reader.read_object<ff::animation_player_base>()));
+        });
+
+    ::restore_components(reader, [this, &reader](entt::entity entity)
+        {
+            this->registry.emplace_or_replace<retron::comp::tracked_object>(entity, std::ref(::tracked_object_count(this->level_spec_.objects, reader.read<size_t>())));
+        });
+
+    this->level_logic.restore(reader);
+    this->level_collision_logic.restore(reader);
+    this->previous_positions_frame = reader.read<size_t>();
+    reader.read(this->previous_positions);
+    this->particles.restore(reader);
+
+    assert(reader.done());
+    return true;
+}
+
+bool retron::level::restart_instant()
+{
+    if (this->start_snapshot.empty())
+    {
+        return false;
+    }
+
+    this->rewind_count = 0;
+    return this->restore_snapshot(this->start_snapshot);
+}
+
 entt::registry& retron::level::host_registry()
 {
     return this->registry;
@@ -145,14 +473,40 @@ size_t retron::level::host_frame_count() const
     return this->frame_count;
 }
 
-void retron::level::host_create_particles(std::string_view name, const ff::point_fixed& pos, const retron::particle_effect_options* options)
+void retron::level::host_create_particles(size_t effect_id, const ff::point_fixed& pos, const retron::particle_effect_options* options)
+{
+    assert(effect_id < this->particle_effect_indexes.size());
+    const retron::particles::effect_t* effect = (effect_id < this->particle_effect_indexes.size())
+        ? this->particle_effects->effect(this->particle_effect_indexes[effect_id])
+        : nullptr;
+    assert(effect);
+
+    if (effect)
+    {
+        effect->add(this->particles, pos, options);
+    }
+}
+
+void retron::level::host_create_event_particles(const ff::dict& event_params, const ff::point_fixed& pos)
 {
-    auto i = this->particle_effects.find(name);
-    assert(i != this->particle_effects.end());
+    // Animation resources keep their event params around, so each name only gets read and looked up once
+    auto i = std::find_if(this->event_particle_indexes.cbegin(), this->event_particle_indexes.cend(), [&event_params](const auto& pair)
+        {
+            return pair.first == &event_params;
+        });
+
+    if (i == this->event_particle_indexes.cend())
+    {
+        this->event_particle_indexes.emplace_back(&event_params, this->particle_effects->index(event_params.get<std::string>("name")));
+        i = this->event_particle_indexes.cend() - 1;
+    }
 
-    if (i != this->particle_effects.end())
+    const retron::particles::effect_t* effect = this->particle_effects->effect(i->second);
+    assert(effect);
+
+    if (effect)
     {
-        i->second.add(this->particles, pos, options);
+        effect->add(this->particles, pos);
     }
 }
 
@@ -180,12 +534,41 @@ void retron::level::host_add_points(const retron::player& player, size_t points)
     this->game_service.player_add_points(player, points);
 }
 
+ff::fixed_int retron::level::host_render_interpolation() const
+{
+    return this->render_interpolation_;
+}
+
+const ff::point_fixed* retron::level::host_previous_position(entt::entity entity) const
+{
+    const size_t index = static_cast<size_t>(entt::to_entity(entity));
+    if (this->previous_positions_frame == this->frame_count && index < this->previous_positions.size() && this->previous_positions[index].entity == entity)
+    {
+        return &this->previous_positions[index].position;
+    }
+
+    return nullptr;
+}
+
+const retron::particles::stats_t& retron::level::particle_stats() const
+{
+    return this->particles.stats();
+}
+
+size_t retron::level::visited_entity_count() const
+{
+    return this->level_logic.visited_entity_count();
+}
+
 void retron::level::init_resources()
 {
-    ff::dict level_particles_dict = ff::auto_resource_value("level_particles").value()->get<ff::dict>();
-    for (std::string_view name : level_particles_dict.child_names())
+    this->particle_effects = retron::particle_effects::get();
+    this->event_particle_indexes.clear(); // params of the old animations are gone
+
+    // Rebuilt effects can have different indexes
+    for (size_t i = 0; i < this->particle_effect_indexes.size(); i++)
     {
-        this->particle_effects.try_emplace(name, retron::particles::effect_t(level_particles_dict.get(name)));
+        this->particle_effect_indexes[i] = this->particle_effects->index(retron::particle_effect_ids::NAMES[i]);
     }
 }
 
@@ -351,9 +734,9 @@ entt::entity retron::level::create_player(const retron::player& player)
 
 void retron::level::create_start_particles(entt::entity entity)
 {
-    auto names = retron::entity_util::start_particle_names_0_90(this->entities.type(entity));
+    auto effect_ids = retron::entity_util::start_particle_ids_0_90(this->entities.type(entity));
 
-    if (names.first.size())
+    if (effect_ids.first)
     {
         retron::particle_effect_options options;
         if (this->entities.category(entity) == retron::entity_category::player)
@@ -367,8 +750,14 @@ void retron::level::create_start_particles(entt::entity entity)
 
         bool vertical = ff::math::random_range(1, 10) > 2 ? true : false;
         ff::point_fixed center = this->collision.box(entity, retron::collision_box_type::bounds_box).center();
-        auto [effect_id, max_life] = this->particle_effects[(vertical && names.second.size()) ? names.second : names.first].add(this->particles, center, &options);
-        this->registry.emplace<retron::comp::showing_particle_effect>(entity, effect_id);
+        const retron::particles::effect_t* effect = this->particle_effects->effect(this->particle_effect_indexes[(vertical && effect_ids.second) ? effect_ids.second : effect_ids.first]);
+        assert(effect);
+
+        if (effect)
+        {
+            auto [effect_id, max_life] = effect->add(this->particles, center, &options);
+            this->registry.emplace<retron::comp::showing_particle_effect>(entity, effect_id);
+        }
     }
 }
 
@@ -407,6 +796,27 @@ void retron::level::create_objects(size_t& count, retron::entity_type type, cons
     }
 }
 
+void retron::level::save_previous_positions()
+{
+    if (!this->interpolating)
+    {
+        return;
+    }
+
+    for (auto [entity, pos] : this->registry.view<const retron::comp::position>().each())
+    {
+        const size_t index = static_cast<size_t>(entt::to_entity(entity));
+        if (index >= this->previous_positions.size())
+        {
+            this->previous_positions.resize(index + 1, previous_position_t{ entt::null });
+        }
+
+        this->previous_positions[index] = previous_position_t{ entity, pos.position };
+    }
+
+    this->previous_positions_frame = this->frame_count + 1;
+}
+
 void retron::level::advance_entities()
 {
     bool player_active = this->player_active();
@@ -476,6 +886,32 @@ void retron::level::advance_phase()
     }
 }
 
+void retron::level::advance_rewind(bool playing)
+{
+    if (!retron::app_service::get().game_spec().allow_debug())
+    {
+        return;
+    }
+
+    if (ff::flags::has(retron::app_service::get().debug_cheats(), retron::debug_cheats_t::rewind))
+    {
+        retron::app_service::get().debug_cheats(ff::flags::clear(retron::app_service::get().debug_cheats(), retron::debug_cheats_t::rewind));
+
+        if (this->rewind_count)
+        {
+            this->rewind_next = (this->rewind_next + this->rewind_snapshots.size() - 1) % this->rewind_snapshots.size();
+            this->rewind_count--;
+            this->restore_snapshot(this->rewind_snapshots[this->rewind_next]);
+        }
+    }
+    else if (playing && !(this->frame_count % ::REWIND_SNAPSHOT_FRAMES))
+    {
+        this->save_snapshot(this->rewind_snapshots[this->rewind_next]);
+        this->rewind_next = (this->rewind_next + 1) % this->rewind_snapshots.size();
+        this->rewind_count = std::min(this->rewind_count + 1, this->rewind_snapshots.size());
+    }
+}
+
 void retron::level::handle_particle_effect_done(int effect_id)
 {
     for (auto [entity, comp] : this->registry.view<const retron::comp::showing_particle_effect>().each())
@@ -619,5 +1055,10 @@ void retron::level::internal_phase(internal_phase_t new_phase)
         this->phase_ = new_phase;
         this->phase_counter = 0;
         this->init_entities();
+
+        if (new_phase == internal_phase_t::playing && this->start_snapshot.empty())
+        {
+            this->save_snapshot(this->start_snapshot);
+        }
     }
 }
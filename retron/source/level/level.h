@@ -2,7 +2,7 @@
 
 #include "source/core/game_spec.h"
 #include "source/core/level_base.h"
-#include "source/core/particles.h"
+#include "source/core/particle_effects.h"
 #include "source/level/collision.h"
 #include "source/level/entities.h"
 #include "source/level/level_logic.h"
@@ -44,17 +44,30 @@ namespace retron
         virtual void restart() override;
         virtual void stop() override;
         virtual const std::vector<const retron::player*>& players() const override;
+        virtual void render_interpolation(ff::fixed_int value) override;
+        virtual void save_snapshot(retron::snapshot& snapshot) const override;
+        virtual bool restore_snapshot(const retron::snapshot& snapshot) override;
+        virtual bool restart_instant() override;
 
         // retron::level_logic_host, retron::level_render_host
         virtual entt::registry& host_registry() override;
         virtual const entt::registry& host_registry() const override;
         virtual const retron::difficulty_spec& host_difficulty_spec() const override;
         virtual size_t host_frame_count() const override;
-        virtual void host_create_particles(std::string_view name, const ff::point_fixed& pos, const retron::particle_effect_options* options = nullptr) override;
+        virtual void host_create_particles(size_t effect_id, const ff::point_fixed& pos, const retron::particle_effect_options* options = nullptr) override;
+        virtual void host_create_event_particles(const ff::dict& event_params, const ff::point_fixed& pos) override;
         virtual void host_create_bullet(entt::entity player_entity, ff::point_fixed shot_vector) override;
         virtual void host_handle_dead_player(entt::entity entity, const retron::player& player) override;
         virtual void host_add_points(const retron::player& player, size_t points) override;
 
+        // retron::level_render_host
+        virtual ff::fixed_int host_render_interpolation() const override;
+        virtual const ff::point_fixed* host_previous_position(entt::entity entity) const override;
+
+        const retron::particles::stats_t& particle_stats() const;
+        size_t visited_entity_count() const; // timer driven entities that level_logic advanced last frame
+        void render(ff::draw_base& draw); // into any draw target, like the headless CPU renderer
+
     private:
         void init_resources();
         void init_entities();
@@ -63,9 +76,11 @@ namespace retron
         void create_start_particles(entt::entity entity);
         void create_objects(size_t& count, retron::entity_type type, const ff::rect_fixed& bounds, const std::function<entt::entity(retron::entity_type, const ff::point_fixed&)>& create_func);
 
+        void save_previous_positions();
         void advance_entities();
         void advance_particle_positions();
         void advance_phase();
+        void advance_rewind(bool playing);
 
         void handle_particle_effect_done(int effect_id);
         void handle_entity_created(entt::registry& registry, entt::entity entity);
@@ -104,12 +119,32 @@ namespace retron
         retron::level_collision_logic level_collision_logic;
         retron::level_render level_render;
 
-        std::unordered_map<std::string_view, retron::particles::effect_t> particle_effects;
+        std::shared_ptr<const retron::particle_effects> particle_effects;
+        std::array<size_t, retron::particle_effect_ids::COUNT> particle_effect_indexes; // resolved in init_resources
+        std::vector<std::pair<const ff::dict*, size_t>> event_particle_indexes; // animation event params to particle_effects indexes, only a few ever fire
         std::forward_list<entt::scoped_connection> connections;
         std::forward_list<ff::signal_connection> ff_connections;
 
         internal_phase_t phase_;
         size_t phase_counter;
         size_t frame_count;
+
+        // Render interpolation, positions are only saved once something renders between ticks
+        struct previous_position_t
+        {
+            entt::entity entity;
+            ff::point_fixed position;
+        };
+
+        std::vector<previous_position_t> previous_positions; // indexed by entt::to_entity
+        size_t previous_positions_frame; // frame_count that the saved positions lead up to
+        ff::fixed_int render_interpolation_;
+        bool interpolating;
+
+        // Snapshots
+        retron::snapshot start_snapshot;
+        std::vector<retron::snapshot> rewind_snapshots;
+        size_t rewind_next;
+        size_t rewind_count;
     };
 }
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "source/core/app_service.h"
 #include "source/core/particles.h"
+#include "source/core/profiler.h"
 #include "source/level/collision.h"
 #include "source/level/components.h"
 #include "source/level/entities.h"
@@ -21,20 +22,28 @@ retron::level_collision_logic::level_collision_logic(retron::level_logic_host& h
 
 void retron::level_collision_logic::handle_collisions()
 {
-    for (auto& [entity1, entity2] : this->collision.detect_collisions(this->collisions, retron::collision_box_type::bounds_box))
     {
-        if (!this->entities.deleted(entity1) && !this->entities.deleted(entity2))
+        retron::profiler::scope profile_scope("collision::bounds");
+
+        for (auto& [entity1, entity2] : this->collision.detect_collisions(this->collisions, retron::collision_box_type::bounds_box))
         {
-            this->handle_bounds_collision(entity1, entity2);
+            if (!this->entities.deleted(entity1) && !this->entities.deleted(entity2))
+            {
+                this->handle_bounds_collision(entity1, entity2);
+            }
         }
     }
 
-    for (auto& [entity1, entity2] : this->collision.detect_collisions(this->collisions, retron::collision_box_type::hit_box))
     {
-        if (!this->entities.deleted(entity1) && !this->entities.deleted(entity2))
+        retron::profiler::scope profile_scope("collision::hits");
+
+        for (auto& [entity1, entity2] : this->collision.detect_collisions(this->collisions, retron::collision_box_type::hit_box))
         {
-            this->handle_entity_collision(entity1, entity2);
-            this->handle_entity_collision(entity2, entity1);
+            if (!this->entities.deleted(entity1) && !this->entities.deleted(entity2))
+            {
+                this->handle_entity_collision(entity1, entity2);
+                this->handle_entity_collision(entity2, entity1);
+            }
         }
     }
 }
@@ -44,6 +53,16 @@ void retron::level_collision_logic::reset()
     this->bonus_collected = 0;
 }
 
+void retron::level_collision_logic::save(retron::snapshot& snapshot) const
+{
+    snapshot.write(this->bonus_collected);
+}
+
+void retron::level_collision_logic::restore(retron::snapshot::reader& reader)
+{
+    this->bonus_collected = reader.read<size_t>();
+}
+
 void retron::level_collision_logic::init_resources()
 {
     this->electrode_die_anims[0] = "anim.electrode_die[0]";
@@ -83,14 +102,20 @@ void retron::level_collision_logic::handle_bounds_collision(entt::entity target_
         case retron::entity_category::enemy:
             if (offset && this->entities.type(target_entity) == retron::entity_type::enemy_hulk)
             {
-                registry.get<retron::comp::hulk>(target_entity).force_turn = true;
+                registry.patch<retron::comp::hulk>(target_entity, [](retron::comp::hulk& comp)
+                    {
+                        comp.force_turn = true;
+                    });
             }
             break;
 
         case retron::entity_category::bonus:
             if (offset)
             {
-                registry.get<retron::comp::bonus>(target_entity).turn_frame = 0;
+                registry.patch<retron::comp::bonus>(target_entity, [](retron::comp::bonus& comp)
+                    {
+                        comp.turn_frame = 0;
+                    });
             }
             break;
     }
@@ -220,11 +245,11 @@ void retron::level_collision_logic::destroy_bullet(entt::entity bullet_entity, e
             retron::particle_effect_options options;
             options.angle = std::make_pair(angle - 60_f, angle + 60_f);
             options.type = static_cast<uint8_t>(retron::entity_util::index(this->entities.type(bullet_entity)));
-            this->host.host_create_particles("player_bullet_explode", pos, &options);
+            this->host.host_create_particles(retron::particle_effect_ids::ID_PLAYER_BULLET_EXPLODE, pos, &options);
 
             if (by_category != retron::entity_category::electrode)
             {
-                this->host.host_create_particles("player_bullet_smoke", pos2);
+                this->host.host_create_particles(retron::particle_effect_ids::ID_PLAYER_BULLET_SMOKE, pos2);
             }
         }
         else
@@ -232,8 +257,8 @@ void retron::level_collision_logic::destroy_bullet(entt::entity bullet_entity, e
             ff::point_fixed pos = this->bounds_box(by_entity).center();
             retron::particle_effect_options options;
             options.type = static_cast<uint8_t>(retron::entity_util::index(this->entities.type(bullet_entity)));
-            this->host.host_create_particles("player_bullet_explode", pos, &options);
-            this->host.host_create_particles("player_bullet_smoke", pos);
+            this->host.host_create_particles(retron::particle_effect_ids::ID_PLAYER_BULLET_EXPLODE, pos, &options);
+            this->host.host_create_particles(retron::particle_effect_ids::ID_PLAYER_BULLET_SMOKE, pos);
         }
     }
 }
@@ -242,13 +267,13 @@ void retron::level_collision_logic::destroy_enemy(entt::entity entity, entt::ent
 {
     if (this->entities.delay_delete(entity))
     {
-        auto names = retron::entity_util::start_particle_names_0_90(this->entities.type(entity));
-        if (names.first.size())
+        auto name_ids = retron::entity_util::start_particle_ids_0_90(this->entities.type(entity));
+        if (name_ids.first)
         {
             retron::particle_effect_options options;
             options.reverse = true;
 
-            std::string_view name;
+            size_t name_id = 0;
             ff::point_fixed center = this->bounds_box(entity).center();
             bool by_bullet = this->entities.category(by_entity) == retron::entity_category::bullet;
 
@@ -256,30 +281,30 @@ void retron::level_collision_logic::destroy_enemy(entt::entity entity, entt::ent
             {
                 case 0:
                 case 4:
-                    name = names.second;
+                    name_id = name_ids.second;
                     break;
 
                 case 1:
                 case 5:
                     options.rotate = 45;
-                    name = names.first;
+                    name_id = name_ids.first;
                     break;
 
                 case 2:
                 case 6:
-                    name = names.first;
+                    name_id = name_ids.first;
                     break;
 
                 case 3:
                 case 7:
                     options.rotate = -45;
-                    name = names.first;
+                    name_id = name_ids.first;
                     break;
             }
 
-            if (name.size())
+            if (name_id)
             {
-                this->host.host_create_particles(name, center, &options);
+                this->host.host_create_particles(name_id, center, &options);
             }
         }
     }
@@ -312,9 +337,15 @@ void retron::level_collision_logic::push_hulk(entt::entity enemy_entity, entt::e
     const retron::difficulty_spec& diff = this->host.host_difficulty_spec();
 
     ff::point_fixed by_vel = this->entities.velocity(by_entity);
-    registry.get<retron::comp::hulk>(enemy_entity).force_push = ff::point_fixed(
+    ff::point_fixed push(
         diff.hulk_push.x * (by_vel.x == 0_f ? 0_f : (by_vel.x < 0_f ? -1_f : 1_f)),
         diff.hulk_push.y * (by_vel.y == 0_f ? 0_f : (by_vel.y < 0_f ? -1_f : 1_f)));
+
+    // Patch so that the hulk gets scheduled to move next frame
+    registry.patch<retron::comp::hulk>(enemy_entity, [push](retron::comp::hulk& comp)
+        {
+            comp.force_push = push;
+        });
 }
 
 void retron::level_collision_logic::add_points(entt::entity player_or_bullet_entity, entt::entity destroyed_entity)
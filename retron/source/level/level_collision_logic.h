@@ -2,6 +2,7 @@
 
 #include "source/core/game_spec.h"
 #include "source/core/level_base.h"
+#include "source/core/snapshot.h"
 
 namespace retron
 {
@@ -16,6 +17,9 @@ namespace retron
         virtual void handle_collisions() override;
         virtual void reset() override;
 
+        void save(retron::snapshot& snapshot) const;
+        void restore(retron::snapshot::reader& reader);
+
     private:
         void init_resources();
         ff::rect_fixed bounds_box(entt::entity entity);
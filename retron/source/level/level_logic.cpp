@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "source/core/app_service.h"
 #include "source/core/game_spec.h"
+#include "source/core/profiler.h"
 #include "source/level/collision.h"
 #include "source/level/components.h"
 #include "source/level/entity_type.h"
@@ -13,19 +14,48 @@ namespace anim_events
     static const size_t DELETE_ANIMATION = ff::stable_hash_func("delete_animation"sv);
 };
 
-retron::level_logic::level_logic(level_logic_host& host, retron::collision& collision)
+static const size_t HULK_MOVE_FRAMES = 8;
+
+static void erase_unordered(std::vector<entt::entity>& entities, entt::entity entity)
+{
+    auto i = std::find(entities.begin(), entities.end(), entity);
+    if (i != entities.end())
+    {
+        *i = entities.back();
+        entities.pop_back();
+    }
+}
+
+retron::level_logic::level_logic(level_logic_host& host, retron::collision& collision, const ff::rect_fixed& level_bounds)
     : host(host)
     , collision(collision)
-{}
+    , hulk_targets(host.host_registry(), level_bounds)
+    , visited_entity_count_(0)
+{
+    entt::registry& registry = this->host.host_registry();
+
+    this->connections.emplace_front(registry.on_construct<retron::comp::grunt>().connect<&retron::level_logic::grunt_created>(this));
+    this->connections.emplace_front(registry.on_destroy<retron::comp::grunt>().connect<&retron::level_logic::grunt_removed>(this));
+    this->connections.emplace_front(registry.on_construct<retron::comp::bonus>().connect<&retron::level_logic::bonus_changed>(this));
+    this->connections.emplace_front(registry.on_update<retron::comp::bonus>().connect<&retron::level_logic::bonus_changed>(this));
+    this->connections.emplace_front(registry.on_destroy<retron::comp::bonus>().connect<&retron::level_logic::bonus_removed>(this));
+    this->connections.emplace_front(registry.on_construct<retron::comp::hulk>().connect<&retron::level_logic::hulk_created>(this));
+    this->connections.emplace_front(registry.on_update<retron::comp::hulk>().connect<&retron::level_logic::hulk_changed>(this));
+    this->connections.emplace_front(registry.on_destroy<retron::comp::hulk>().connect<&retron::level_logic::hulk_removed>(this));
+    this->connections.emplace_front(registry.on_destroy<retron::comp::flag::hulk_target>().connect<&retron::level_logic::hulk_target_removed>(this));
+}
 
 void retron::level_logic::advance_time(retron::entity_category categories)
 {
     entt::registry& registry = this->host.host_registry();
     const retron::difficulty_spec& diff = this->host.host_difficulty_spec();
     size_t frame_count = this->host.host_frame_count();
+    this->visited_entity_count_ = 0;
 
     if (ff::flags::has(categories, retron::entity_category::animation))
     {
+        retron::profiler::scope profile_scope("level_logic::animations");
+
         for (auto [entity, comp, pos] : registry.view<retron::comp::animation, const retron::comp::position>().each())
         {
             this->advance_animation(entity, comp, pos);
@@ -34,27 +64,62 @@ void retron::level_logic::advance_time(retron::entity_category categories)
 
     if (ff::flags::has(categories, retron::entity_category::enemy))
     {
-        for (auto [entity, comp, pos] : registry.view<retron::comp::grunt, const retron::comp::position>().each())
+        retron::profiler::scope profile_scope("level_logic::enemies");
+
+        for (entt::entity entity : this->grunt_timers.advance(frame_count, this->expired_entities))
         {
-            this->advance_grunt(entity, comp, pos);
+            if (registry.valid(entity))
+            {
+                auto [comp, pos] = registry.try_get<retron::comp::grunt, const retron::comp::position>(entity);
+                if (comp && pos)
+                {
+                    this->advance_grunt(entity, *comp, *pos);
+                    this->grunt_timers.schedule(comp->move_frame, entity);
+                    this->visited_entity_count_++;
+                }
+            }
         }
 
-        for (auto [entity, comp, pos, vel] : registry.view<retron::comp::hulk, const retron::comp::position, const retron::comp::velocity>().each())
+        this->hulk_targets.update();
+
+        for (entt::entity entity : this->hulk_timers.advance(frame_count, this->expired_entities))
         {
-            this->advance_hulk(entity, comp, pos, vel);
+            if (registry.valid(entity))
+            {
+                auto [comp, pos, vel] = registry.try_get<retron::comp::hulk, const retron::comp::position, const retron::comp::velocity>(entity);
+                if (comp && pos && vel)
+                {
+                    this->advance_hulk(entity, *comp, *pos, *vel);
+                    this->hulk_timers.schedule(this->next_hulk_frame(*comp, *vel), entity);
+                    this->visited_entity_count_++;
+                }
+            }
         }
     }
 
     if (ff::flags::has(categories, retron::entity_category::bonus))
     {
-        for (auto [entity, comp, pos, vel] : registry.view<retron::comp::bonus, const retron::comp::position, const retron::comp::velocity>().each())
+        retron::profiler::scope profile_scope("level_logic::bonuses");
+
+        for (entt::entity entity : this->bonus_timers.advance(frame_count, this->expired_entities))
         {
-            this->advance_bonus(entity, comp, pos, vel);
+            if (registry.valid(entity))
+            {
+                auto [comp, pos, vel] = registry.try_get<retron::comp::bonus, const retron::comp::position, const retron::comp::velocity>(entity);
+                if (comp && pos && vel)
+                {
+                    this->advance_bonus(entity, *comp, *pos, *vel);
+                    this->bonus_timers.schedule(this->next_bonus_frame(*comp), entity);
+                    this->visited_entity_count_++;
+                }
+            }
         }
     }
 
     if (ff::flags::has(categories, retron::entity_category::bullet))
     {
+        retron::profiler::scope profile_scope("level_logic::bullets");
+
         for (auto [entity, pos, vel] : registry.view<retron::comp::bullet, const retron::comp::position, const retron::comp::velocity>().each())
         {
             registry.replace<retron::comp::position>(entity, pos.position + vel.velocity);
@@ -63,17 +128,21 @@ void retron::level_logic::advance_time(retron::entity_category categories)
 
     if (ff::flags::has(categories, retron::entity_category::player))
     {
+        retron::profiler::scope profile_scope("level_logic::players");
+
         for (auto [entity, comp, pos, vel] : registry.view<retron::comp::player, const retron::comp::position, const retron::comp::velocity>().each())
         {
             this->advance_player(entity, comp, pos, vel);
         }
     }
 
-    for (size_t& i : this->next_hulk_group_turn)
+    for (size_t i = 0; i < this->next_hulk_group_turn.size(); i++)
     {
-        if (i < frame_count)
+        size_t& turn = this->next_hulk_group_turn[i];
+        if (turn < frame_count)
         {
-            i = frame_count + ff::math::random_range(diff.hulk_min_ticks, diff.hulk_max_ticks) * diff.hulk_tick_frames;
+            turn = frame_count + ff::math::random_range(diff.hulk_min_ticks, diff.hulk_max_ticks) * diff.hulk_tick_frames;
+            this->schedule_hulk_group(i, turn);
         }
     }
 }
@@ -81,6 +150,35 @@ void retron::level_logic::advance_time(retron::entity_category categories)
 void retron::level_logic::reset()
 {
     this->next_hulk_group_turn.clear();
+    this->hulk_groups.clear();
+    this->hulk_chasers.clear();
+    this->grunt_timers.reset();
+    this->bonus_timers.reset();
+    this->hulk_timers.reset();
+    this->visited_entity_count_ = 0;
+}
+
+size_t retron::level_logic::visited_entity_count() const
+{
+    return this->visited_entity_count_;
+}
+
+void retron::level_logic::save(retron::snapshot& snapshot) const
+{
+    snapshot.write(this->next_hulk_group_turn);
+    this->grunt_timers.save(snapshot);
+    this->bonus_timers.save(snapshot);
+    this->hulk_timers.save(snapshot);
+}
+
+void retron::level_logic::restore(retron::snapshot::reader& reader)
+{
+    // Timers were scheduled while restoring components, replace them with the saved ones
+    reader.read(this->next_hulk_group_turn);
+    this->grunt_timers.restore(reader);
+    this->bonus_timers.restore(reader);
+    this->hulk_timers.restore(reader);
+    this->visited_entity_count_ = 0;
 }
 
 void retron::level_logic::advance_player(entt::entity entity, retron::comp::player& comp, const retron::comp::position& pos, const retron::comp::velocity& vel)
@@ -173,7 +271,7 @@ void retron::level_logic::advance_hulk(entt::entity entity, retron::comp::hulk&
     {
         if (!registry.valid(comp.target_entity))
         {
-            comp.target_entity = this->pick_hulk_target(entity);
+            this->hulk_target(entity, comp, this->pick_hulk_target(entity));
         }
 
         if (registry.valid(comp.target_entity))
@@ -198,7 +296,7 @@ void retron::level_logic::advance_hulk(entt::entity entity, retron::comp::hulk&
         comp.force_turn = false;
     }
 
-    ff::point_fixed final_vel = comp.force_push + (vel.velocity * ((frame_count % 8) ? 0_f : 1_f));
+    ff::point_fixed final_vel = comp.force_push + (vel.velocity * ((frame_count % ::HULK_MOVE_FRAMES) ? 0_f : 1_f));
     comp.force_push = {};
 
     if (final_vel)
@@ -236,7 +334,7 @@ void retron::level_logic::advance_animation(entt::entity entity, retron::comp::a
     {
         if (event.event_id == anim_events::NEW_PARTICLES && event.params)
         {
-            this->host.host_create_particles(event.params->get<std::string>("name"), pos.position);
+            this->host.host_create_event_particles(*event.params, pos.position);
         }
         else if (event.event_id == anim_events::DELETE_ANIMATION)
         {
@@ -323,21 +421,141 @@ entt::entity retron::level_logic::pick_grunt_player_target(size_t enemy_index) c
 entt::entity retron::level_logic::pick_hulk_target(entt::entity entity) const
 {
     const entt::registry& registry = this->host.host_registry();
-    entt::entity target_entity = entt::null;
-    ff::fixed_int target_dist = -1;
-    ff::point_fixed pos = registry.get<const retron::comp::position>(entity).position;
+    return this->hulk_targets.nearest(registry.get<const retron::comp::position>(entity).position);
+}
+
+size_t retron::level_logic::next_bonus_frame(const retron::comp::bonus& comp) const
+{
+    const retron::difficulty_spec& diff = this->host.host_difficulty_spec();
+    size_t frame_count = this->host.host_frame_count();
 
-    for (entt::entity cur_entity : registry.view<const retron::comp::flag::hulk_target>())
+    // Bonuses only move on tick frames that line up with their turn frame
+    size_t delta = (comp.turn_frame - frame_count) % diff.bonus_tick_frames;
+    return frame_count + (delta ? delta : diff.bonus_tick_frames);
+}
+
+size_t retron::level_logic::next_hulk_frame(const retron::comp::hulk& comp, const retron::comp::velocity& vel) const
+{
+    const entt::registry& registry = this->host.host_registry();
+    size_t frame_count = this->host.host_frame_count();
+
+    if (!vel.velocity || !registry.valid(comp.target_entity))
     {
-        ff::point_fixed cur_pos = registry.get<const retron::comp::position>(cur_entity).position;
-        ff::fixed_int cur_dist = (cur_pos - pos).length_squared();
+        // Keep looking for a target and direction every frame
+        return frame_count + 1;
+    }
+
+    size_t next_frame = (frame_count / ::HULK_MOVE_FRAMES + 1) * ::HULK_MOVE_FRAMES;
+    size_t turn = this->next_hulk_group_turn[comp.group];
+
+    // The group keeps turning until its next turn is picked at the end of the frame after it started
+    if (turn >= frame_count)
+    {
+        next_frame = std::min(next_frame, std::max(turn, frame_count + 1));
+    }
+
+    return next_frame;
+}
 
-        if (target_dist < 0_f || cur_dist < target_dist)
+void retron::level_logic::schedule_hulk_group(size_t group, size_t frame)
+{
+    if (group < this->hulk_groups.size())
+    {
+        for (entt::entity entity : this->hulk_groups[group])
         {
-            target_entity = cur_entity;
-            target_dist = cur_dist;
+            this->hulk_timers.schedule(frame, entity);
         }
     }
+}
+
+void retron::level_logic::hulk_target(entt::entity entity, retron::comp::hulk& comp, entt::entity target_entity)
+{
+    auto i = this->hulk_chasers.find(comp.target_entity);
+    if (i != this->hulk_chasers.end())
+    {
+        ::erase_unordered(i->second, entity);
+    }
+
+    comp.target_entity = target_entity;
+
+    if (target_entity != entt::null)
+    {
+        this->hulk_chasers[target_entity].push_back(entity);
+    }
+}
+
+void retron::level_logic::grunt_created(entt::registry& registry, entt::entity entity)
+{
+    this->grunt_timers.schedule(this->host.host_frame_count(), entity);
+}
+
+void retron::level_logic::grunt_removed(entt::registry& registry, entt::entity entity)
+{
+    this->grunt_timers.cancel(entity);
+}
+
+void retron::level_logic::bonus_changed(entt::registry& registry, entt::entity entity)
+{
+    this->bonus_timers.schedule(this->host.host_frame_count(), entity);
+}
+
+void retron::level_logic::bonus_removed(entt::registry& registry, entt::entity entity)
+{
+    this->bonus_timers.cancel(entity);
+}
+
+void retron::level_logic::hulk_created(entt::registry& registry, entt::entity entity)
+{
+    // Restored hulks already have a target
+    const retron::comp::hulk& comp = registry.get<const retron::comp::hulk>(entity);
+
+    if (comp.group >= this->hulk_groups.size())
+    {
+        this->hulk_groups.resize(comp.group + 1);
+    }
+
+    this->hulk_groups[comp.group].push_back(entity);
+
+    if (comp.target_entity != entt::null)
+    {
+        this->hulk_chasers[comp.target_entity].push_back(entity);
+    }
+
+    this->hulk_changed(registry, entity);
+}
+
+void retron::level_logic::hulk_changed(entt::registry& registry, entt::entity entity)
+{
+    this->hulk_timers.schedule(this->host.host_frame_count(), entity);
+}
+
+void retron::level_logic::hulk_removed(entt::registry& registry, entt::entity entity)
+{
+    retron::comp::hulk& comp = registry.get<retron::comp::hulk>(entity);
+
+    if (comp.group < this->hulk_groups.size())
+    {
+        ::erase_unordered(this->hulk_groups[comp.group], entity);
+    }
+
+    this->hulk_target(entity, comp, entt::null);
+    this->hulk_timers.cancel(entity);
+}
+
+void retron::level_logic::hulk_target_removed(entt::registry& registry, entt::entity entity)
+{
+    auto i = this->hulk_chasers.find(entity);
+    if (i == this->hulk_chasers.end())
+    {
+        return;
+    }
+
+    size_t frame_count = this->host.host_frame_count();
+
+    for (entt::entity hulk_entity : i->second)
+    {
+        this->hulk_timers.schedule(frame_count, hulk_entity);
+    }
 
-    return target_entity;
+    this->hulk_chasers.erase(i);
 }
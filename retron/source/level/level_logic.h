@@ -1,6 +1,8 @@
 #pragma once
 
 #include "source/core/level_base.h"
+#include "source/level/target_grid.h"
+#include "source/level/timer_wheel.h"
 
 namespace retron::comp
 {
@@ -21,11 +23,16 @@ namespace retron
     class level_logic : public retron::level_logic_base
     {
     public:
-        level_logic(retron::level_logic_host& host, retron::collision& collision);
+        level_logic(retron::level_logic_host& host, retron::collision& collision, const ff::rect_fixed& level_bounds);
 
         virtual void advance_time(retron::entity_category categories) override;
         virtual void reset() override;
 
+        size_t visited_entity_count() const;
+
+        void save(retron::snapshot& snapshot) const;
+        void restore(retron::snapshot::reader& reader);
+
     private:
         void advance_player(entt::entity entity, retron::comp::player& comp, const retron::comp::position& pos, const retron::comp::velocity& vel);
         void advance_grunt(entt::entity entity, retron::comp::grunt& comp, const retron::comp::position& pos);
@@ -38,8 +45,33 @@ namespace retron
         entt::entity pick_grunt_player_target(size_t enemy_index) const;
         entt::entity pick_hulk_target(entt::entity entity) const;
 
+        size_t next_bonus_frame(const retron::comp::bonus& comp) const;
+        size_t next_hulk_frame(const retron::comp::hulk& comp, const retron::comp::velocity& vel) const;
+        void schedule_hulk_group(size_t group, size_t frame);
+        void hulk_target(entt::entity entity, retron::comp::hulk& comp, entt::entity target_entity);
+
+        void grunt_created(entt::registry& registry, entt::entity entity);
+        void grunt_removed(entt::registry& registry, entt::entity entity);
+        void bonus_changed(entt::registry& registry, entt::entity entity);
+        void bonus_removed(entt::registry& registry, entt::entity entity);
+        void hulk_created(entt::registry& registry, entt::entity entity);
+        void hulk_changed(entt::registry& registry, entt::entity entity);
+        void hulk_removed(entt::registry& registry, entt::entity entity);
+        void hulk_target_removed(entt::registry& registry, entt::entity entity);
+
         retron::level_logic_host& host;
         retron::collision& collision;
+        std::forward_list<entt::scoped_connection> connections;
         std::vector<size_t> next_hulk_group_turn;
+        std::vector<std::vector<entt::entity>> hulk_groups; // hulks in each group
+        std::unordered_map<entt::entity, std::vector<entt::entity>> hulk_chasers; // hulks chasing each target
+        retron::target_grid hulk_targets;
+
+        // Timers
+        retron::timer_wheel grunt_timers;
+        retron::timer_wheel bonus_timers;
+        retron::timer_wheel hulk_timers;
+        std::vector<entt::entity> expired_entities;
+        size_t visited_entity_count_;
     };
 }
@@ -14,10 +14,25 @@ retron::level_render::level_render(retron::level_render_host& host)
     this->init_resources();
 }
 
+static ff::point_fixed render_position(const retron::level_render_host& host, entt::entity entity, const ff::point_fixed& pos, ff::fixed_int interpolation)
+{
+    if (interpolation < 1_f)
+    {
+        const ff::point_fixed* prev = host.host_previous_position(entity);
+        if (prev)
+        {
+            return *prev + (pos - *prev) * interpolation;
+        }
+    }
+
+    return pos;
+}
+
 void retron::level_render::render(ff::draw_base& draw)
 {
     const entt::registry& registry = this->host.host_registry();
     const retron::difficulty_spec& diff = this->host.host_difficulty_spec();
+    const ff::fixed_int interpolation = this->host.host_render_interpolation();
     size_t frame_count = this->host.host_frame_count();
 
     for (auto [entity, comp] : registry.view<const retron::comp::rectangle>().each())
@@ -25,45 +40,46 @@ void retron::level_render::render(ff::draw_base& draw)
         draw.draw_palette_outline_rectangle(comp.rect, comp.color, comp.thickness);
     }
 
+    this->render_items.clear();
+
     for (auto [entity, comp, pos] : registry.view<const retron::comp::animation, const retron::comp::position>(entt::exclude_t<retron::comp::flag::render_on_top>()).each())
     {
         const retron::comp::scale* scale = registry.try_get<const retron::comp::scale>(entity);
         const retron::comp::rotation* rot = registry.try_get<const retron::comp::rotation>(entity);
 
-        comp.anim->draw_animation(draw, ff::pixel_transform(pos.position, scale ? scale->scale : ff::point_fixed{ 1, 1 }, rot ? rot->rotation : 0_f));
+        this->add_item(layer_t::bottom_animations, comp.anim.get(), ff::pixel_transform(::render_position(this->host, entity, pos.position, interpolation), scale ? scale->scale : ff::point_fixed{ 1, 1 }, rot ? rot->rotation : 0_f));
     }
 
     for (auto [entity, pos, type] : registry.view<const retron::comp::electrode, const retron::comp::position, const retron::entity_type>().each())
     {
-        this->electrode_anims[retron::entity_util::index(type)]->draw_frame(draw, ff::pixel_transform(pos.position), 0);
+        this->add_item(layer_t::electrodes, retron::entity_util::index(type), this->electrode_anims[retron::entity_util::index(type)].object().get(), 0, ff::pixel_transform(::render_position(this->host, entity, pos.position, interpolation)));
     }
 
     for (auto [entity, comp, pos] : registry.view<const retron::comp::grunt, const retron::comp::position>(entt::exclude_t<retron::comp::showing_particle_effect>()).each())
     {
-        this->grunt_walk_anim->draw_frame(draw, ff::pixel_transform(pos.position), 0);
+        this->add_item(layer_t::grunts, 0, this->grunt_walk_anim.object().get(), 0, ff::pixel_transform(::render_position(this->host, entity, pos.position, interpolation)));
     }
 
     for (auto [entity, comp, pos] : registry.view<const retron::comp::hulk, const retron::comp::position>(entt::exclude_t<retron::comp::showing_particle_effect>()).each())
     {
-        this->hulk_walk_anim->draw_frame(draw, ff::pixel_transform(pos.position), 0);
+        this->add_item(layer_t::hulks, 0, this->hulk_walk_anim.object().get(), 0, ff::pixel_transform(::render_position(this->host, entity, pos.position, interpolation)));
     }
 
     for (auto [entity, comp, pos, type] : registry.view<const retron::comp::bonus, const retron::comp::position, const retron::entity_type>().each())
     {
-        this->bonus_anims[retron::entity_util::index(type)]->draw_frame(draw, ff::pixel_transform(pos.position), 0);
+        this->add_item(layer_t::bonuses, retron::entity_util::index(type), this->bonus_anims[retron::entity_util::index(type)].object().get(), 0, ff::pixel_transform(::render_position(this->host, entity, pos.position, interpolation)));
     }
 
     for (auto [entity, pos, rot] : registry.view<const retron::comp::bullet, const retron::comp::position, const retron::comp::rotation>().each())
     {
-        this->player_bullet_anim->draw_frame(draw, ff::pixel_transform(pos.position, { 1, 1 }, rot.rotation), 0);
+        this->add_item(layer_t::bullets, 0, this->player_bullet_anim.object().get(), 0, ff::pixel_transform(::render_position(this->host, entity, pos.position, interpolation), { 1, 1 }, rot.rotation));
     }
 
     for (auto [entity, comp, pos, dir, vel] : registry.view<const retron::comp::player, const retron::comp::position, const retron::comp::direction, const retron::comp::velocity>(entt::exclude_t<retron::comp::showing_particle_effect>()).each())
     {
-        ff::animation_base* anim = this->player_walk_anims[retron::helpers::dir_to_index(dir.direction)].object().get();
+        const size_t anim_index = retron::helpers::dir_to_index(dir.direction);
+        ff::animation_base* anim = this->player_walk_anims[anim_index].object().get();
         ff::fixed_int frame = vel.velocity ? ff::fixed_int(frame_count) / diff.player_move_frame_divisor : 0_f;
-        ff::palette_base& palette = retron::app_service::get().player_palette(comp.player.get().index);
-        draw.push_palette_remap(palette.index_remap(), palette.index_remap_hash());
 
         switch (comp.state)
         {
@@ -100,10 +116,9 @@ void retron::level_render::render(ff::draw_base& draw)
 
         if (anim)
         {
-            anim->draw_frame(draw, ff::pixel_transform(pos.position), frame);
+            ff::palette_base& palette = retron::app_service::get().player_palette(comp.player.get().index);
+            this->add_item(layer_t::players, anim_index, anim, frame, ff::pixel_transform(::render_position(this->host, entity, pos.position, interpolation)), &palette);
         }
-
-        draw.pop_palette_remap();
     }
 
     for (auto [entity, comp, pos] : registry.view<const retron::comp::animation, const retron::comp::position, const retron::comp::flag::render_on_top>().each())
@@ -111,10 +126,80 @@ void retron::level_render::render(ff::draw_base& draw)
         const retron::comp::scale* scale = registry.try_get<const retron::comp::scale>(entity);
         const retron::comp::rotation* rot = registry.try_get<const retron::comp::rotation>(entity);
 
-        comp.anim->draw_animation(draw, ff::pixel_transform(pos.position, scale ? scale->scale : ff::point_fixed{ 1, 1 }, rot ? rot->rotation : 0_f));
+        this->add_item(layer_t::top_animations, comp.anim.get(), ff::pixel_transform(::render_position(this->host, entity, pos.position, interpolation), scale ? scale->scale : ff::point_fixed{ 1, 1 }, rot ? rot->rotation : 0_f));
+    }
+
+    // Electrodes are placed apart and never move, so they can be grouped by animation to batch.
+    // Everything else can overlap, so it keeps its order to keep the same sprite on top.
+    std::sort(this->render_items.begin(), this->render_items.end(), [](const render_item_t& lhs, const render_item_t& rhs)
+        {
+            if (lhs.layer != rhs.layer)
+            {
+                return lhs.layer < rhs.layer;
+            }
+
+            if (lhs.layer == layer_t::electrodes)
+            {
+                return std::tie(lhs.batch, lhs.order) < std::tie(rhs.batch, rhs.order);
+            }
+
+            return lhs.order < rhs.order;
+        });
+
+    const uint8_t* remap = nullptr;
+
+    for (const render_item_t& item : this->render_items)
+    {
+        if (item.remap != remap)
+        {
+            if (remap)
+            {
+                draw.pop_palette_remap();
+            }
+
+            if (item.remap)
+            {
+                draw.push_palette_remap(item.remap, item.remap_hash);
+            }
+
+            remap = item.remap;
+        }
+
+        if (item.player)
+        {
+            item.player->draw_animation(draw, item.transform);
+        }
+        else
+        {
+            item.anim->draw_frame(draw, item.transform, item.frame);
+        }
+    }
+
+    if (remap)
+    {
+        draw.pop_palette_remap();
     }
 }
 
+void retron::level_render::add_item(layer_t layer, size_t batch, ff::animation_base* anim, ff::fixed_int frame, const ff::pixel_transform& transform, ff::palette_base* palette)
+{
+    render_item_t item{ layer, static_cast<uint32_t>(this->render_items.size()), 0, nullptr, batch, anim, nullptr, frame, transform };
+
+    if (palette)
+    {
+        item.remap = palette->index_remap();
+        item.remap_hash = palette->index_remap_hash();
+    }
+
+    this->render_items.push_back(item);
+}
+
+void retron::level_render::add_item(layer_t layer, ff::animation_player_base* player, const ff::pixel_transform& transform)
+{
+    // Each entity has its own player, so these don't batch and just keep their order
+    this->render_items.push_back(render_item_t{ layer, static_cast<uint32_t>(this->render_items.size()), 0, nullptr, 0, nullptr, player, 0, transform });
+}
+
 void retron::level_render::init_resources()
 {
     this->player_walk_anims[0] = "anim.player_walk_right";
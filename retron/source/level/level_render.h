@@ -13,10 +13,39 @@ namespace retron
         virtual void render(ff::draw_base& draw) override;
 
     private:
+        // Draw order between layers never changes. Within a layer, items keep their order, except electrodes are grouped by batch.
+        enum class layer_t : uint8_t
+        {
+            bottom_animations,
+            electrodes,
+            grunts,
+            hulks,
+            bonuses,
+            bullets,
+            players,
+            top_animations,
+        };
+
+        struct render_item_t
+        {
+            layer_t layer;
+            uint32_t order; // draw order within a layer
+            size_t remap_hash; // zero without a remap
+            const uint8_t* remap;
+            size_t batch; // which of the layer's animations, a stable index so the order doesn't depend on where resources live
+            ff::animation_base* anim;
+            ff::animation_player_base* player; // used instead of anim
+            ff::fixed_int frame;
+            ff::pixel_transform transform;
+        };
+
         void init_resources();
+        void add_item(layer_t layer, size_t batch, ff::animation_base* anim, ff::fixed_int frame, const ff::pixel_transform& transform, ff::palette_base* palette = nullptr);
+        void add_item(layer_t layer, ff::animation_player_base* player, const ff::pixel_transform& transform);
 
         retron::level_render_host& host;
         std::forward_list<ff::signal_connection> connections;
+        std::vector<render_item_t> render_items;
 
         std::array<ff::auto_resource<ff::animation_base>, 8> player_walk_anims;
         std::array<ff::auto_resource<ff::animation_base>, 3> electrode_anims;
@@ -0,0 +1,204 @@
+#include "pch.h"
+#include "source/level/components.h"
+#include "source/level/entity_type.h"
+#include "source/level/replay.h"
+
+static const uint32_t REPLAY_MAGIC = 0x50525452; // "RTRP"
+static const uint32_t REPLAY_VERSION = 1;
+static const uint64_t HASH_OFFSET = 0xcbf29ce484222325;
+static const uint64_t HASH_PRIME = 0x100000001b3;
+static const uint32_t MAX_STRING_SIZE = 1024; // IDs from the game spec
+static const uint64_t MAX_FRAME_COUNT = 60 * 60 * 60 * 24; // a day of play
+
+template<class T>
+static uint64_t hash_value(uint64_t hash, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+
+    for (size_t i = 0; i < sizeof(T); i++)
+    {
+        hash = (hash ^ bytes[i]) * ::HASH_PRIME;
+    }
+
+    return hash;
+}
+
+template<class T>
+static void write_value(std::ostream& stream, const T& value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T>
+static bool read_value(std::istream& stream, T& value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+static void write_string(std::ostream& stream, const std::string& value)
+{
+    ::write_value(stream, static_cast<uint32_t>(value.size()));
+    stream.write(value.data(), value.size());
+}
+
+// A corrupt size mustn't turn into a huge allocation, so sizes are checked against what's left to read
+static bool check_size(std::istream& stream, uint64_t size)
+{
+    std::istream::pos_type pos = stream.tellg();
+    if (pos == std::istream::pos_type(-1))
+    {
+        return true;
+    }
+
+    stream.seekg(0, std::ios::end);
+    std::istream::pos_type end = stream.tellg();
+    stream.seekg(pos);
+
+    return end != std::istream::pos_type(-1) && size <= static_cast<uint64_t>(end - pos);
+}
+
+static bool read_string(std::istream& stream, std::string& value)
+{
+    uint32_t size = 0;
+    if (!::read_value(stream, size) || size > ::MAX_STRING_SIZE || !::check_size(stream, size))
+    {
+        return false;
+    }
+
+    value.resize(size);
+    return static_cast<bool>(stream.read(value.data(), size));
+}
+
+retron::replay::replay()
+    : seed_(0)
+{}
+
+retron::replay::replay(uint32_t seed, std::string_view difficulty_id, std::string_view level_id)
+    : difficulty_id_(difficulty_id)
+    , level_id_(level_id)
+    , seed_(seed)
+{}
+
+retron::replay::input_t retron::replay::make_input(const ff::point_fixed& move, const ff::point_fixed& shot)
+{
+    ff::point_int move_int = retron::helpers::canon_dir(move).cast<int>();
+    ff::point_int shot_int = retron::helpers::canon_dir(shot).cast<int>();
+
+    return retron::replay::input_t
+    {
+        static_cast<int8_t>(move_int.x),
+        static_cast<int8_t>(move_int.y),
+        static_cast<int8_t>(shot_int.x),
+        static_cast<int8_t>(shot_int.y),
+    };
+}
+
+uint64_t retron::replay::hash_state(const entt::registry& registry, size_t frame_count)
+{
+    // Entity hashes are summed so the result doesn't depend on pool iteration order
+    uint64_t entities_hash = 0;
+    size_t entity_count = 0;
+
+    registry.view<const retron::entity_type>().each([&registry, &entities_hash, &entity_count](entt::entity entity, retron::entity_type type)
+        {
+            uint64_t hash = ::hash_value(::HASH_OFFSET, entity);
+            hash = ::hash_value(hash, type);
+
+            if (const retron::comp::position* pos = registry.try_get<const retron::comp::position>(entity))
+            {
+                hash = ::hash_value(hash, pos->position);
+            }
+
+            if (const retron::comp::player* player = registry.try_get<const retron::comp::player>(entity))
+            {
+                hash = ::hash_value(hash, player->state);
+                hash = ::hash_value(hash, player->state_counter);
+                hash = ::hash_value(hash, player->allow_shot_frame);
+            }
+
+            entities_hash += hash;
+            entity_count++;
+        });
+
+    uint64_t hash = ::hash_value(::HASH_OFFSET, static_cast<uint64_t>(frame_count));
+    hash = ::hash_value(hash, static_cast<uint64_t>(entity_count));
+    return ::hash_value(hash, entities_hash);
+}
+
+void retron::replay::add_frame(const frame_t& frame)
+{
+    this->frames.push_back(frame);
+}
+
+const retron::replay::frame_t* retron::replay::frame(size_t index) const
+{
+    return (index < this->frames.size()) ? &this->frames[index] : nullptr;
+}
+
+size_t retron::replay::frame_count() const
+{
+    return this->frames.size();
+}
+
+uint32_t retron::replay::seed() const
+{
+    return this->seed_;
+}
+
+const std::string& retron::replay::difficulty_id() const
+{
+    return this->difficulty_id_;
+}
+
+const std::string& retron::replay::level_id() const
+{
+    return this->level_id_;
+}
+
+bool retron::replay::save(std::ostream& stream) const
+{
+    ::write_value(stream, ::REPLAY_MAGIC);
+    ::write_value(stream, ::REPLAY_VERSION);
+    ::write_value(stream, this->seed_);
+    ::write_string(stream, this->difficulty_id_);
+    ::write_string(stream, this->level_id_);
+    ::write_value(stream, static_cast<uint64_t>(this->frames.size()));
+
+    for (const frame_t& frame : this->frames)
+    {
+        ::write_value(stream, frame);
+    }
+
+    return static_cast<bool>(stream);
+}
+
+bool retron::replay::load(std::istream& stream)
+{
+    uint32_t magic = 0, version = 0;
+    uint64_t frame_count = 0;
+
+    if (!::read_value(stream, magic) || magic != ::REPLAY_MAGIC ||
+        !::read_value(stream, version) || version != ::REPLAY_VERSION ||
+        !::read_value(stream, this->seed_) ||
+        !::read_string(stream, this->difficulty_id_) ||
+        !::read_string(stream, this->level_id_) ||
+        !::read_value(stream, frame_count) ||
+        frame_count > ::MAX_FRAME_COUNT ||
+        !::check_size(stream, frame_count * sizeof(frame_t)))
+    {
+        return false;
+    }
+
+    this->frames.resize(static_cast<size_t>(frame_count));
+
+    for (frame_t& frame : this->frames)
+    {
+        if (!::read_value(stream, frame))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
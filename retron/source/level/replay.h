@@ -0,0 +1,45 @@
+#pragma once
+
+namespace retron
+{
+    // Player input and a hash of the level state for every frame, so a run can be simulated again and checked
+    class replay
+    {
+    public:
+        struct input_t
+        {
+            int8_t move_x;
+            int8_t move_y;
+            int8_t shot_x;
+            int8_t shot_y;
+        };
+
+        struct frame_t
+        {
+            std::array<input_t, retron::constants::MAX_PLAYERS> inputs;
+            uint64_t hash;
+        };
+
+        replay();
+        replay(uint32_t seed, std::string_view difficulty_id, std::string_view level_id);
+
+        static input_t make_input(const ff::point_fixed& move, const ff::point_fixed& shot);
+        static uint64_t hash_state(const entt::registry& registry, size_t frame_count);
+
+        void add_frame(const frame_t& frame);
+        const frame_t* frame(size_t index) const;
+        size_t frame_count() const;
+        uint32_t seed() const;
+        const std::string& difficulty_id() const;
+        const std::string& level_id() const;
+
+        bool save(std::ostream& stream) const;
+        bool load(std::istream& stream);
+
+    private:
+        std::vector<frame_t> frames;
+        std::string difficulty_id_;
+        std::string level_id_;
+        uint32_t seed_;
+    };
+}
@@ -0,0 +1,151 @@
+#include "pch.h"
+#include "source/level/components.h"
+#include "source/level/target_grid.h"
+
+static const int CELL_SIZE = 32;
+
+static ff::point_int grid_size(const ff::rect_fixed& bounds)
+{
+    ff::point_int size = bounds.size().cast<int>();
+    return ff::point_int(std::max((size.x + ::CELL_SIZE - 1) / ::CELL_SIZE, 1), std::max((size.y + ::CELL_SIZE - 1) / ::CELL_SIZE, 1));
+}
+
+retron::target_grid::target_grid(entt::registry& registry, const ff::rect_fixed& bounds)
+    : registry(registry)
+    , origin(bounds.top_left())
+    , grid_size(::grid_size(bounds))
+    , cells(static_cast<size_t>(this->grid_size.x * this->grid_size.y))
+{
+    this->connections.emplace_front(this->registry.on_construct<retron::comp::flag::hulk_target>().connect<&retron::target_grid::target_added>(this));
+    this->connections.emplace_front(this->registry.on_destroy<retron::comp::flag::hulk_target>().connect<&retron::target_grid::target_removed>(this));
+}
+
+void retron::target_grid::update()
+{
+    for (auto [entity, pos] : this->registry.view<const retron::comp::flag::hulk_target, const retron::comp::position>().each())
+    {
+        size_t index = this->cell_index(this->cell_pos(pos.position));
+        auto i = this->entity_to_cell.find(entity);
+
+        if (i == this->entity_to_cell.end())
+        {
+            // Didn't have a position yet when it became a target
+            this->cells[index].push_back(entity);
+            this->entity_to_cell.try_emplace(entity, index);
+        }
+        else if (index != i->second)
+        {
+            this->remove_from_cell(i->second, entity);
+            this->cells[index].push_back(entity);
+            i->second = index;
+        }
+    }
+}
+
+entt::entity retron::target_grid::nearest(const ff::point_fixed& pos) const
+{
+    entt::entity target_entity = entt::null;
+    ff::fixed_int target_dist = -1;
+    ff::point_int center = this->cell_pos(pos);
+
+    for (int ring = 0, max_ring = std::max(this->grid_size.x, this->grid_size.y); ring <= max_ring; ring++)
+    {
+        // Nothing in this ring or beyond can be closer than what was already found
+        if (target_dist >= 0_f && this->ring_distance_squared(pos, center, ring) > target_dist)
+        {
+            break;
+        }
+
+        for (int y = std::max(center.y - ring, 0); y <= std::min(center.y + ring, this->grid_size.y - 1); y++)
+        {
+            bool full_row = (y == center.y - ring || y == center.y + ring);
+
+            for (int x = center.x - ring; x <= center.x + ring; x += full_row ? 1 : ring * 2)
+            {
+                if (x >= 0 && x < this->grid_size.x)
+                {
+                    for (entt::entity entity : this->cells[this->cell_index(ff::point_int(x, y))])
+                    {
+                        ff::point_fixed cur_pos = this->registry.get<const retron::comp::position>(entity).position;
+                        ff::fixed_int cur_dist = (cur_pos - pos).length_squared();
+
+                        if (target_dist < 0_f || cur_dist < target_dist)
+                        {
+                            target_entity = entity;
+                            target_dist = cur_dist;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return target_entity;
+}
+
+ff::point_int retron::target_grid::cell_pos(const ff::point_fixed& pos) const
+{
+    ff::point_int cell = (pos - this->origin).cast<int>() / ::CELL_SIZE;
+    return ff::point_int(std::clamp(cell.x, 0, this->grid_size.x - 1), std::clamp(cell.y, 0, this->grid_size.y - 1));
+}
+
+size_t retron::target_grid::cell_index(const ff::point_int& cell) const
+{
+    return static_cast<size_t>(cell.y * this->grid_size.x + cell.x);
+}
+
+ff::fixed_int retron::target_grid::ring_distance_squared(const ff::point_fixed& pos, const ff::point_int& cell, int ring) const
+{
+    if (!ring)
+    {
+        return 0;
+    }
+
+    // Distance from pos to the outside of all cells in the previous rings
+    ff::fixed_int left = this->origin.x + (cell.x - ring + 1) * ::CELL_SIZE;
+    ff::fixed_int top = this->origin.y + (cell.y - ring + 1) * ::CELL_SIZE;
+    ff::fixed_int right = this->origin.x + (cell.x + ring) * ::CELL_SIZE;
+    ff::fixed_int bottom = this->origin.y + (cell.y + ring) * ::CELL_SIZE;
+
+    if (pos.x < left || pos.x > right || pos.y < top || pos.y > bottom)
+    {
+        return 0;
+    }
+
+    ff::fixed_int dist = std::min(std::min(pos.x - left, right - pos.x), std::min(pos.y - top, bottom - pos.y));
+    return dist * dist;
+}
+
+void retron::target_grid::remove_from_cell(size_t index, entt::entity entity)
+{
+    std::vector<entt::entity>& cell = this->cells[index];
+    auto i = std::find(cell.begin(), cell.end(), entity);
+    assert(i != cell.end());
+
+    if (i != cell.end())
+    {
+        *i = cell.back();
+        cell.pop_back();
+    }
+}
+
+void retron::target_grid::target_added(entt::registry& registry, entt::entity entity)
+{
+    const retron::comp::position* pos = this->registry.try_get<const retron::comp::position>(entity);
+    if (pos)
+    {
+        size_t index = this->cell_index(this->cell_pos(pos->position));
+        this->cells[index].push_back(entity);
+        this->entity_to_cell.insert_or_assign(entity, index);
+    }
+}
+
+void retron::target_grid::target_removed(entt::registry& registry, entt::entity entity)
+{
+    auto i = this->entity_to_cell.find(entity);
+    if (i != this->entity_to_cell.end())
+    {
+        this->remove_from_cell(i->second, entity);
+        this->entity_to_cell.erase(i);
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+namespace retron
+{
+    // Grid of hulk target entities (players and bonuses) for nearest neighbor queries, covering the level bounds.
+    // Targets are added and removed through signals, and moved into their new cells by update().
+    class target_grid
+    {
+    public:
+        target_grid(entt::registry& registry, const ff::rect_fixed& bounds);
+
+        void update(); // before querying, only targets are checked so other entities can move freely
+        entt::entity nearest(const ff::point_fixed& pos) const;
+
+    private:
+        ff::point_int cell_pos(const ff::point_fixed& pos) const;
+        size_t cell_index(const ff::point_int& cell) const;
+        ff::fixed_int ring_distance_squared(const ff::point_fixed& pos, const ff::point_int& cell, int ring) const;
+        void remove_from_cell(size_t index, entt::entity entity);
+
+        void target_added(entt::registry& registry, entt::entity entity);
+        void target_removed(entt::registry& registry, entt::entity entity);
+
+        entt::registry& registry;
+        std::forward_list<entt::scoped_connection> connections;
+        ff::point_fixed origin;
+        ff::point_int grid_size;
+        std::vector<std::vector<entt::entity>> cells;
+        std::unordered_map<entt::entity, size_t> entity_to_cell; // only targets
+    };
+}
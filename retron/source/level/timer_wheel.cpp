@@ -0,0 +1,206 @@
+#include "pch.h"
+#include "source/level/timer_wheel.h"
+
+static size_t entity_index(entt::entity entity)
+{
+    return static_cast<size_t>(entt::to_entity(entity));
+}
+
+retron::timer_wheel::timer_wheel()
+    : current(0)
+    , size_(0)
+{}
+
+void retron::timer_wheel::schedule(size_t frame, entt::entity entity)
+{
+    const size_t index = ::entity_index(entity);
+    if (index >= this->timers.size())
+    {
+        this->timers.resize(index + 1, entry_t{ retron::timer_wheel::NO_FRAME, entt::null });
+    }
+
+    entry_t& timer = this->timers[index];
+    if (timer.entity == entity && timer.frame <= frame)
+    {
+        return;
+    }
+
+    if (timer.frame == retron::timer_wheel::NO_FRAME)
+    {
+        this->size_++;
+    }
+
+    // Any entry still in the wheel for this index is now stale, it gets skipped when it expires
+    timer = entry_t{ frame, entity };
+    this->insert(timer);
+}
+
+void retron::timer_wheel::cancel(entt::entity entity)
+{
+    const size_t index = ::entity_index(entity);
+    if (index < this->timers.size() && this->timers[index].entity == entity && this->timers[index].frame != retron::timer_wheel::NO_FRAME)
+    {
+        this->timers[index] = entry_t{ retron::timer_wheel::NO_FRAME, entt::null };
+        this->size_--;
+    }
+}
+
+const std::vector<entt::entity>& retron::timer_wheel::advance(size_t frame, std::vector<entt::entity>& expired)
+{
+    expired.clear();
+    this->expiring.clear();
+    std::swap(this->expiring, this->due);
+
+    while (this->current < frame)
+    {
+        this->tick();
+    }
+
+    for (const entry_t& entry : this->expiring)
+    {
+        if (this->live(entry))
+        {
+            this->timers[::entity_index(entry.entity)] = entry_t{ retron::timer_wheel::NO_FRAME, entt::null };
+            this->size_--;
+            expired.push_back(entry.entity);
+        }
+    }
+
+    // Same visiting order no matter how the timers were scheduled
+    std::sort(expired.begin(), expired.end());
+    return expired;
+}
+
+void retron::timer_wheel::reset()
+{
+    for (auto& level : this->levels)
+    {
+        for (auto& slot : level)
+        {
+            slot.clear();
+        }
+    }
+
+    this->overflow.clear();
+    this->due.clear();
+    this->timers.clear();
+    this->current = 0;
+    this->size_ = 0;
+}
+
+size_t retron::timer_wheel::size() const
+{
+    return this->size_;
+}
+
+void retron::timer_wheel::save(retron::snapshot& snapshot) const
+{
+    std::vector<entry_t> entries;
+    entries.reserve(this->size_);
+
+    for (const entry_t& timer : this->timers)
+    {
+        if (timer.frame != retron::timer_wheel::NO_FRAME)
+        {
+            entries.push_back(timer);
+        }
+    }
+
+    snapshot.write(this->current);
+    snapshot.write(entries);
+}
+
+void retron::timer_wheel::restore(retron::snapshot::reader& reader)
+{
+    std::vector<entry_t> entries;
+
+    this->reset();
+    this->current = reader.read<size_t>();
+    reader.read(entries);
+
+    for (const entry_t& entry : entries)
+    {
+        this->schedule(entry.frame, entry.entity);
+    }
+}
+
+void retron::timer_wheel::insert(const entry_t& entry)
+{
+    if (entry.frame <= this->current)
+    {
+        this->due.push_back(entry);
+        return;
+    }
+
+    size_t delta = entry.frame - this->current;
+
+    for (size_t level = 0; level < retron::timer_wheel::LEVEL_COUNT; level++)
+    {
+        size_t shift = level * retron::timer_wheel::SLOT_BITS;
+        if (delta < (static_cast<size_t>(retron::timer_wheel::SLOT_COUNT) << shift))
+        {
+            this->levels[level][(entry.frame >> shift) & retron::timer_wheel::SLOT_MASK].push_back(entry);
+            return;
+        }
+    }
+
+    this->overflow.push_back(entry);
+}
+
+bool retron::timer_wheel::live(const entry_t& entry) const
+{
+    const entry_t& timer = this->timers[::entity_index(entry.entity)];
+    return timer.entity == entry.entity && timer.frame == entry.frame;
+}
+
+void retron::timer_wheel::tick()
+{
+    this->current++;
+
+    for (size_t level = 1; level <= retron::timer_wheel::LEVEL_COUNT; level++)
+    {
+        if ((this->current >> ((level - 1) * retron::timer_wheel::SLOT_BITS)) & retron::timer_wheel::SLOT_MASK)
+        {
+            break;
+        }
+
+        this->cascade(level);
+    }
+
+    std::vector<entry_t>& slot = this->levels[0][this->current & retron::timer_wheel::SLOT_MASK];
+    for (const entry_t& entry : slot)
+    {
+        assert(entry.frame == this->current);
+        this->expiring.push_back(entry);
+    }
+
+    slot.clear();
+
+    // Cascaded entries that are already due
+    this->expiring.insert(this->expiring.end(), this->due.begin(), this->due.end());
+    this->due.clear();
+}
+
+void retron::timer_wheel::cascade(size_t level)
+{
+    this->cascading.clear();
+
+    if (level < retron::timer_wheel::LEVEL_COUNT)
+    {
+        std::vector<entry_t>& slot = this->levels[level][(this->current >> (level * retron::timer_wheel::SLOT_BITS)) & retron::timer_wheel::SLOT_MASK];
+        std::swap(this->cascading, slot);
+    }
+    else
+    {
+        std::swap(this->cascading, this->overflow);
+    }
+
+    for (const entry_t& entry : this->cascading)
+    {
+        // Stale entries don't need to move down
+        if (this->live(entry))
+        {
+            this->insert(entry);
+        }
+    }
+}
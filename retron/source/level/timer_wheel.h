@@ -0,0 +1,51 @@
+#pragma once
+
+#include "source/core/snapshot.h"
+
+namespace retron
+{
+    // Hierarchical timer wheel keyed by frame number, so only entities whose timers expire get visited.
+    // Each entity has at most one timer, scheduling again only moves it earlier.
+    class timer_wheel
+    {
+    public:
+        timer_wheel();
+
+        void schedule(size_t frame, entt::entity entity);
+        void cancel(entt::entity entity);
+        const std::vector<entt::entity>& advance(size_t frame, std::vector<entt::entity>& expired);
+        void reset();
+        size_t size() const; // entities with a timer
+
+        void save(retron::snapshot& snapshot) const;
+        void restore(retron::snapshot::reader& reader);
+
+    private:
+        static const size_t SLOT_BITS = 6;
+        static const size_t SLOT_COUNT = 1 << SLOT_BITS;
+        static const size_t SLOT_MASK = SLOT_COUNT - 1;
+        static const size_t LEVEL_COUNT = 4;
+
+        struct entry_t
+        {
+            size_t frame;
+            entt::entity entity;
+        };
+
+        static const size_t NO_FRAME = static_cast<size_t>(-1);
+
+        void insert(const entry_t& entry);
+        bool live(const entry_t& entry) const;
+        void tick();
+        void cascade(size_t level);
+
+        std::array<std::array<std::vector<entry_t>, SLOT_COUNT>, LEVEL_COUNT> levels;
+        std::vector<entry_t> overflow;
+        std::vector<entry_t> due;
+        std::vector<entry_t> cascading;
+        std::vector<entry_t> expiring;
+        std::vector<entry_t> timers; // the live timer for each entity index, older entries in the slots are stale
+        size_t current;
+        size_t size_;
+    };
+}
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "source/core/app_service.h"
 #include "source/core/options.h"
+#include "source/headless/headless_main.h"
 #include "source/states/app_state.h"
 #include "source/ui/debug_page.xaml.h"
 #include "source/ui/particle_lab_page.xaml.h"
@@ -23,7 +24,7 @@ static const std::string_view NOESIS_NAME = "d704047b-5bd2-4757-9858-6a7d86cdd00
 static const std::string_view NOESIS_KEY = "c02GygIEhsoRJpvqrPLSUToofFKSJ+imAbUl5jO5fcHl54P6";
 static std::weak_ptr<retron::app_state> weak_app_state;
 
-static void register_components()
+static void register_resources()
 {
     ::res::register_bonus();
     ::res::register_controls();
@@ -33,6 +34,11 @@ static void register_components()
     ::res::register_particles();
     ::res::register_player();
     ::res::register_sprites();
+}
+
+static void register_components()
+{
+    ::register_resources();
     ::res::register_xaml();
 
     Noesis::RegisterComponent<Noesis::EnumConverter<retron::game_flags>>();
@@ -258,8 +264,53 @@ static void handle_window_message(ff::window_message& msg)
     }
 }
 
+static std::vector<std::string> command_line_args()
+{
+    std::vector<std::string> args;
+
+    for (int i = 1; i < __argc; i++)
+    {
+        args.push_back(ff::string::to_string(std::wstring_view(__wargv[i])));
+    }
+
+    return args;
+}
+
+static void attach_console()
+{
+    // The desktop app isn't a console app, so attach to the console that launched it
+    if (::AttachConsole(ATTACH_PARENT_PROCESS))
+    {
+        FILE* file = nullptr;
+        ::freopen_s(&file, "CONOUT$", "w", stdout);
+        ::freopen_s(&file, "CONOUT$", "w", stderr);
+    }
+}
+
+static int run_headless(const std::vector<std::string>& args)
+{
+    // Resources still need a graphics device to load textures, but no window, swap chain or UI is created
+    ff::init_graphics init_graphics;
+    if (!init_graphics)
+    {
+        std::cerr << "Failed to initialize graphics\n";
+        return 1;
+    }
+
+    ::register_resources();
+    return retron::headless_main(args, std::cout, std::cerr);
+}
+
 int WINAPI wWinMain(HINSTANCE instance, HINSTANCE, LPWSTR, int)
 {
+    std::vector<std::string> args = ::command_line_args();
+    ::attach_console();
+
+    if (retron::headless_requested(args))
+    {
+        return ::run_headless(args);
+    }
+
     ff::init_app init_app(::get_app_params(), ::get_ui_params());
     ff::signal_connection message_connection = ff::window::main()->message_sink().connect(::handle_window_message);
     return ff::handle_messages_until_quit();
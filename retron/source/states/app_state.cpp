@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "source/core/audio.h"
+#include "source/core/profiler.h"
 #include "source/game/game_state.h"
 #include "source/states/app_state.h"
 #include "source/states/debug_state.h"
@@ -10,22 +11,30 @@
 #include "source/ui/debug_page.xaml.h"
 #include "source/ui/particle_lab_page.xaml.h"
 
-static const float PALETTE_CYCLES_PER_SECOND = 0.25f;
-static retron::app_service* app_service;
+static const std::array<size_t, 4> FAST_FORWARD_RENDER_EVERY{ 1, 10, 60, 0 };
+static const std::chrono::milliseconds FAST_FORWARD_INPUT_INTERVAL(250); // when not rendering, still read the debug keys this often
 
-retron::app_service& retron::app_service::get()
+static void report_debug_text(const std::string& text)
 {
-    assert(::app_service);
-    return *::app_service;
+    // The desktop app attaches to the console it was started from, so this shows up there too
+    std::cout << text << std::flush;
+    ::OutputDebugStringA(text.c_str());
 }
 
-ff::draw_ptr retron::app_service::begin_palette_draw()
+static void toggle_profiler()
 {
-    retron::render_targets& targets = *retron::app_service::get().render_targets();
-    ff::dx11_target_base& target = *targets.target(retron::render_target_types::palette_1);
-    ff::dx11_depth& depth = *targets.depth(retron::render_target_types::palette_1);
-
-    return retron::app_service::get().draw_device().begin_draw(target, &depth, retron::constants::RENDER_RECT, retron::constants::RENDER_RECT);
+    if (!retron::profiler::enabled())
+    {
+        retron::profiler::clear();
+        retron::profiler::enabled(true);
+    }
+    else
+    {
+        // Open with chrome://tracing or ui.perfetto.dev
+        retron::profiler::enabled(false);
+        std::ofstream stream(std::filesystem::temp_directory_path() / "retron_trace.json");
+        retron::profiler::write_chrome_trace(stream);
+    }
 }
 
 retron::app_state::app_state()
@@ -35,6 +44,9 @@ retron::app_state::app_state()
     , debug_stepping_frames(false)
     , debug_step_one_frame(false)
     , debug_time_scale(1.0)
+    , debug_fast_forward_frames(0)
+    , debug_fast_forward_render_every(::FAST_FORWARD_RENDER_EVERY[2])
+    , debug_fast_forward(false)
     , rebuilding_resources_(false)
     , pending_hide_debug_state(false)
     , render_debug_(retron::render_debug_t::none)
@@ -42,9 +54,6 @@ retron::app_state::app_state()
     , texture_1080(std::make_shared<ff::dx11_texture>(retron::constants::RENDER_SIZE_HIGH.cast<int>(), DXGI_FORMAT_R8G8B8A8_UNORM))
     , target_1080(std::make_shared<ff::dx11_target_texture>(this->texture_1080))
 {
-    assert(!::app_service);
-    ::app_service = this;
-
     this->connections.emplace_front(ff::custom_debug_sink().connect(std::bind(&retron::app_state::on_custom_debug, this)));
     this->connections.emplace_front(ff::global_resources::rebuilt_sink().connect(std::bind(&retron::app_state::on_resources_rebuilt, this)));
     this->connections.emplace_front(ff::request_save_settings_sink().connect(std::bind(&retron::app_state::save_settings, this)));
@@ -56,12 +65,6 @@ retron::app_state::app_state()
     this->apply_system_options();
 }
 
-retron::app_state::~app_state()
-{
-    assert(::app_service == this);
-    ::app_service = nullptr;
-}
-
 std::shared_ptr<ff::state> retron::app_state::advance_time()
 {
     if (this->pending_hide_debug_state)
@@ -70,15 +73,7 @@ std::shared_ptr<ff::state> retron::app_state::advance_time()
         this->debug_state->hide();
     }
 
-    for (auto& i : this->player_palettes)
-    {
-        if (i)
-        {
-            i->advance();
-        }
-    }
-
-    return ff::state::advance_time();
+    return this->debug_fast_forward ? this->advance_fast_forward() : this->advance_one_frame();
 }
 
 void retron::app_state::advance_input()
@@ -128,6 +123,42 @@ void retron::app_state::advance_input()
                 this->debug_cheats_ = ff::flags::set(this->debug_cheats_, retron::debug_cheats_t::complete_level);
             }
 
+            if (this->debug_input_events->event_hit(input_events::ID_DEBUG_REWIND))
+            {
+                this->debug_cheats_ = ff::flags::set(this->debug_cheats_, retron::debug_cheats_t::rewind);
+            }
+
+            if (this->debug_input_events->event_hit(input_events::ID_DEBUG_PROFILE_TOGGLE))
+            {
+                ::toggle_profiler();
+            }
+
+            if (this->debug_input_events->event_hit(input_events::ID_DEBUG_FAST_FORWARD_TOGGLE))
+            {
+                this->debug_fast_forward = !this->debug_fast_forward;
+                this->debug_fast_forward_start = std::chrono::steady_clock::now();
+                this->debug_fast_forward_frames = 0;
+            }
+
+            if (this->debug_input_events->event_hit(input_events::ID_DEBUG_FAST_FORWARD_RENDER_EVERY))
+            {
+                auto i = std::find(::FAST_FORWARD_RENDER_EVERY.cbegin(), ::FAST_FORWARD_RENDER_EVERY.cend(), this->debug_fast_forward_render_every);
+                i = (i == ::FAST_FORWARD_RENDER_EVERY.cend() || i + 1 == ::FAST_FORWARD_RENDER_EVERY.cend()) ? ::FAST_FORWARD_RENDER_EVERY.cbegin() : i + 1;
+                this->debug_fast_forward_render_every = *i;
+
+                std::ostringstream message;
+                if (*i)
+                {
+                    message << "Fast forward: render every " << *i << " simulated frames\n";
+                }
+                else
+                {
+                    message << "Fast forward: never render\n";
+                }
+
+                ::report_debug_text(message.str());
+            }
+
 #ifdef _DEBUG
             if (this->debug_input_events->event_hit(input_events::ID_SHOW_CUSTOM_DEBUG))
             {
@@ -157,6 +188,7 @@ void retron::app_state::advance_input()
         this->debug_step_one_frame = false;
         this->debug_stepping_frames = false;
         this->debug_time_scale = 1.0;
+        this->debug_fast_forward = false;
     }
 
     ff::state::advance_input();
@@ -164,6 +196,11 @@ void retron::app_state::advance_input()
 
 void retron::app_state::render(ff::dx11_target_base& target, ff::dx11_depth& depth)
 {
+    if (this->debug_fast_forward && !this->debug_fast_forward_render_every)
+    {
+        return;
+    }
+
     ff::graphics::dx11_device_state().clear_target(this->target_1080->view(), ff::color::none());
 
     this->push_render_targets(this->render_targets_);
@@ -272,6 +309,12 @@ void retron::app_state::pop_render_targets(ff::dx11_target_base& final_target)
     this->render_targets_stack.pop_back();
 }
 
+ff::fixed_int retron::app_state::render_interpolation() const
+{
+    // The pacer renders right after each tick and doesn't expose its leftover time yet, so render the latest tick
+    return 1_f;
+}
+
 ff::signal_sink<>& retron::app_state::reload_resources_sink()
 {
     return this->reload_resources_signal;
@@ -364,6 +407,12 @@ ff::state::advance_t retron::app_state::advance_type() const
         return ff::state::advance_t::stopped;
     }
 
+    if (this->debug_fast_forward)
+    {
+        // Otherwise the pacer adds or drops advances to keep up with the clock, fast forward does its own looping
+        return ff::state::advance_t::single_step;
+    }
+
     return ff::state::advance_t::running;
 }
 
@@ -395,10 +444,54 @@ void retron::app_state::init_resources()
 
     for (size_t i = 0; i < this->player_palettes.size(); i++)
     {
-        std::ostringstream str;
-        str << "player_" << i;
-        this->player_palettes[i] = std::make_shared<ff::palette_cycle>(this->palette_data.object(), str.str().c_str(), ::PALETTE_CYCLES_PER_SECOND);
+        this->player_palettes[i] = retron::helpers::create_player_palette(this->palette_data.object(), i);
+    }
+}
+
+std::shared_ptr<ff::state> retron::app_state::advance_one_frame()
+{
+    for (auto& i : this->player_palettes)
+    {
+        if (i)
+        {
+            i->advance();
+        }
+    }
+
+    return ff::state::advance_time();
+}
+
+std::shared_ptr<ff::state> retron::app_state::advance_fast_forward()
+{
+    // Runs frames back to back without waiting for the pacer, until it's time to render or to read input again
+    const auto start_time = std::chrono::steady_clock::now();
+    std::shared_ptr<ff::state> new_state;
+
+    for (size_t i = 0; !new_state; i++)
+    {
+        if (this->debug_fast_forward_render_every
+            ? i == this->debug_fast_forward_render_every
+            : std::chrono::steady_clock::now() - start_time >= ::FAST_FORWARD_INPUT_INTERVAL)
+        {
+            break;
+        }
+
+        new_state = this->advance_one_frame();
+        this->debug_fast_forward_frames++;
     }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->debug_fast_forward_start;
+    if (elapsed.count() >= 1.0)
+    {
+        std::ostringstream message;
+        message << "Fast forward: " << static_cast<size_t>(this->debug_fast_forward_frames / elapsed.count()) << " simulated frames per second\n";
+        ::report_debug_text(message.str());
+
+        this->debug_fast_forward_start = std::chrono::steady_clock::now();
+        this->debug_fast_forward_frames = 0;
+    }
+
+    return new_state;
 }
 
 void retron::app_state::on_custom_debug()
@@ -13,7 +13,6 @@ namespace retron
     {
     public:
         app_state();
-        virtual ~app_state() override;
 
         // State
         virtual std::shared_ptr<ff::state> advance_time() override;
@@ -35,6 +34,7 @@ namespace retron
         virtual retron::render_targets* render_targets() const override;
         virtual void push_render_targets(retron::render_targets& targets) override;
         virtual void pop_render_targets(ff::dx11_target_base& final_target) override;
+        virtual ff::fixed_int render_interpolation() const override;
         virtual ff::signal_sink<>& reload_resources_sink() override;
         virtual bool rebuilding_resources() const override;
         virtual retron::render_debug_t render_debug() const override;
@@ -53,6 +53,9 @@ namespace retron
         void apply_system_options();
         void save_settings();
 
+        std::shared_ptr<ff::state> advance_one_frame();
+        std::shared_ptr<ff::state> advance_fast_forward();
+
         void on_custom_debug();
         void on_resources_rebuilt();
 
@@ -84,6 +87,10 @@ namespace retron
         retron::render_debug_t render_debug_;
         retron::debug_cheats_t debug_cheats_;
         double debug_time_scale;
+        std::chrono::steady_clock::time_point debug_fast_forward_start;
+        size_t debug_fast_forward_frames;
+        size_t debug_fast_forward_render_every; // simulated frames per render, 0 never renders
+        bool debug_fast_forward;
         bool debug_stepping_frames;
         bool debug_step_one_frame;
         bool rebuilding_resources_;
@@ -31,7 +31,7 @@ void retron::particle_lab_state::render()
     }
 }
 
-void retron::particle_lab_state::on_mouse_click(int button, ff::point_float pos, std::string_view name, retron::particles::effect_t& effect)
+void retron::particle_lab_state::on_mouse_click(int button, ff::point_float pos, std::string_view name, const retron::particles::effect_t& effect)
 {
     if (button == VK_LBUTTON)
     {
@@ -14,7 +14,7 @@ namespace retron
         virtual void render() override;
 
     private:
-        void on_mouse_click(int button, ff::point_float pos, std::string_view name, retron::particles::effect_t& effect);
+        void on_mouse_click(int button, ff::point_float pos, std::string_view name, const retron::particles::effect_t& effect);
 
         std::shared_ptr<ff::ui_view> view;
         std::forward_list<ff::signal_connection> connections;
@@ -33,24 +33,20 @@ void retron::particle_lab_page_view_model::selected_particle_effect(Noesis::Base
     }
 }
 
-retron::particles::effect_t* retron::particle_lab_page_view_model::find_effect(std::string_view name)
+const retron::particles::effect_t* retron::particle_lab_page_view_model::find_effect(std::string_view name) const
 {
-    auto i = this->name_to_effect.find(name);
-    return (i != this->name_to_effect.cend()) ? &i->second : nullptr;
+    return this->effects->find(name);
 }
 
 void retron::particle_lab_page_view_model::init_particle_effects()
 {
     int selected_index = this->particle_effects->IndexOf(this->selected_particle_effect());
     this->particle_effects->Clear();
-    this->name_to_effect.clear();
+    this->effects = retron::particle_effects::get();
 
-    ff::dict level_particles_dict = ff::auto_resource_value("level_particles").value()->get<ff::dict>();
-    for (std::string_view name : level_particles_dict.child_names(true))
+    for (const std::string& name : this->effects->names())
     {
-        std::string name_str = std::string(name);
-        this->name_to_effect.try_emplace(name, retron::particles::effect_t(level_particles_dict.get(name)));
-        this->particle_effects->Add(Noesis::Boxing::Box(name_str.c_str()));
+        this->particle_effects->Add(Noesis::Boxing::Box(name.c_str()));
     }
 
     if (selected_index >= 0 && selected_index < this->particle_effects->Count())
@@ -84,7 +80,7 @@ retron::particle_lab_page_view_model* retron::particle_lab_page::view_model() co
     return this->view_model_;
 }
 
-ff::signal_sink<int, ff::point_float, std::string_view, retron::particles::effect_t&>& retron::particle_lab_page::clicked_sink()
+ff::signal_sink<int, ff::point_float, std::string_view, const retron::particles::effect_t&>& retron::particle_lab_page::clicked_sink()
 {
     return this->clicked_signal;
 }
@@ -117,7 +113,7 @@ void retron::particle_lab_page::on_mouse_down(Noesis::BaseComponent* sender, con
     {
         ff::point_float pos(args.position.x, args.position.y);
         std::string_view name(Noesis::Boxing::Unbox<Noesis::String>(selected).Str());
-        retron::particles::effect_t* effect = this->view_model_->find_effect(name);
+        const retron::particles::effect_t* effect = this->view_model_->find_effect(name);
 
         if (effect)
         {
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "source/core/particles.h"
+#include "source/core/particle_effects.h"
 
 namespace retron
 {
@@ -11,7 +11,7 @@ namespace retron
 
         Noesis::BaseComponent* selected_particle_effect() const;
         void selected_particle_effect(Noesis::BaseComponent* value);
-        retron::particles::effect_t* find_effect(std::string_view name);
+        const retron::particles::effect_t* find_effect(std::string_view name) const;
 
     private:
         void init_particle_effects();
@@ -21,7 +21,7 @@ namespace retron
         Noesis::Ptr<Noesis::ICommand> rebuild_resources_command;
         Noesis::Ptr<Noesis::ObservableCollection<Noesis::BaseComponent>> particle_effects;
         Noesis::Ptr<Noesis::BaseComponent> selected_particle_effect_;
-        std::unordered_map<std::string_view, retron::particles::effect_t> name_to_effect;
+        std::shared_ptr<const retron::particle_effects> effects;
         std::forward_list<ff::signal_connection> connections;
 
         NS_DECLARE_REFLECTION(retron::particle_lab_page_view_model, ff::ui::notify_propety_changed_base);
@@ -33,14 +33,14 @@ namespace retron
         particle_lab_page();
 
         retron::particle_lab_page_view_model* view_model() const;
-        ff::signal_sink<int, ff::point_float, std::string_view, retron::particles::effect_t&>& clicked_sink();
+        ff::signal_sink<int, ff::point_float, std::string_view, const retron::particles::effect_t&>& clicked_sink();
 
     private:
         virtual bool ConnectEvent(Noesis::BaseComponent* source, const char* event, const char* handler) override;
         void on_mouse_down(Noesis::BaseComponent* sender, const Noesis::MouseButtonEventArgs& args);
 
         Noesis::Ptr<retron::particle_lab_page_view_model> view_model_;
-        ff::signal<int, ff::point_float, std::string_view, retron::particles::effect_t&> clicked_signal;
+        ff::signal<int, ff::point_float, std::string_view, const retron::particles::effect_t&> clicked_signal;
 
         NS_DECLARE_REFLECTION(retron::particle_lab_page, Noesis::UserControl);
     };